@@ -0,0 +1,56 @@
+// MakeTrace converts a recorded workload into the binary trace replayed by the "trace" load profile of both simulations.
+// The input has one arrival per line as "time,id,size", with the time in microseconds; lines that do not parse are skipped.
+// Arrivals are sorted by time and their times made relative to the first.
+// Usage: MakeTrace <input csv> <output trace>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+
+#include "../Proof-of-Work/TraceFile.h"
+
+static void writeLittleEndian(std::ofstream& out, uint64_t value, int count) {
+	for (int i = 0; i < count; i++) {
+		out.put(static_cast<char>(value & 0xFF));
+		value >>= 8;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "usage: MakeTrace <input csv> <output trace>" << std::endl;
+		return 1;
+	}
+	std::ifstream in(argv[1]);
+	if (!in) {
+		std::cerr << "could not open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::vector<TraceRecord> records;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::stringstream ss(line);
+		unsigned long long time;
+		unsigned long id, size;
+		if (ss >> time >> id >> size) records.push_back({ time, static_cast<uint32_t>(id), static_cast<uint32_t>(size) });
+	}
+	std::stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) { return a.time < b.time; });
+
+	std::ofstream out(argv[2], std::ios::binary);
+	out.write("TXTRACE", 8);
+	writeLittleEndian(out, TraceFile::VERSION, 4);
+	writeLittleEndian(out, 0, 4);
+	uint64_t first = (records.size() > 0 ? records.front().time : 0);
+	for (const TraceRecord& r : records) {
+		writeLittleEndian(out, r.time - first, 8);
+		writeLittleEndian(out, r.id, 4);
+		writeLittleEndian(out, r.size, 4);
+	}
+	std::cerr << records.size() << " arrivals written" << std::endl;
+	return 0;
+}
@@ -0,0 +1,95 @@
+// Timing and reporting shared by the microbenchmarks of both simulations.
+// Each microbenchmark executable includes this from the file that provides its main.
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+
+#ifndef MEASURE_H
+#define MEASURE_H
+
+// minimum time spent measuring each benchmark
+static const double MINIMUM_SECONDS = 0.5;
+// thread counts used by the benchmarks of shared data structures
+static const unsigned THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+struct Result {
+	std::string name;
+	std::vector<std::pair<std::string, long long>> parameters;
+	unsigned long long operations;
+	double seconds;
+};
+
+static std::vector<Result> results;
+
+// results of benchmarked calls are accumulated here so the compiler cannot remove the calls
+static std::atomic<unsigned long long> sink(0);
+
+// repeats a batch of operations, doubling the batch size until the minimum time has been spent
+// the function performs the given number of operations and returns how many it actually completed
+inline void measure(std::string name, std::vector<std::pair<std::string, long long>> parameters, std::function<unsigned long long(unsigned long long)> run) {
+	unsigned long long batch = 1;
+	while (true) {
+		auto start = std::chrono::steady_clock::now();
+		unsigned long long operations = run(batch);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (seconds >= MINIMUM_SECONDS) {
+			results.push_back({ name, parameters, operations, seconds });
+			std::cerr << name << " " << std::fixed << std::setprecision(1) << seconds * 1e9 / operations << " ns/op" << std::endl;
+			return;
+		}
+		batch *= 2;
+	}
+}
+
+// runs the same function on a number of threads at once, returning the total operations completed
+inline unsigned long long concurrently(unsigned threads, std::function<unsigned long long(unsigned)> run) {
+	std::vector<std::thread> workers;
+	std::vector<unsigned long long> operations(threads);
+	for (unsigned i = 0; i < threads; i++) {
+		workers.push_back(std::thread([&, i] { operations[i] = run(i); }));
+	}
+	unsigned long long total = 0;
+	for (unsigned i = 0; i < threads; i++) {
+		workers[i].join();
+		total += operations[i];
+	}
+	return total;
+}
+
+inline std::string toJSON() {
+	std::stringstream ss;
+	ss << std::setprecision(10);
+	ss << "{\n  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		ss << "    {\"name\": \"" << r.name << "\", \"parameters\": {";
+		for (size_t j = 0; j < r.parameters.size(); j++) {
+			ss << (j ? ", " : "") << "\"" << r.parameters[j].first << "\": " << r.parameters[j].second;
+		}
+		ss << "}, \"operations\": " << r.operations;
+		ss << ", \"seconds\": " << r.seconds;
+		ss << ", \"ns_per_op\": " << r.seconds * 1e9 / r.operations;
+		ss << ", \"ops_per_second\": " << r.operations / r.seconds << "}";
+		ss << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	ss << "  ]\n}\n";
+	return ss.str();
+}
+
+// results are written as JSON to the file given as the first argument, or to the console
+inline void report(int argc, char* argv[]) {
+	if (argc > 1) {
+		std::ofstream out(argv[1]);
+		out << toJSON();
+	}
+	else std::cout << toJSON();
+}
+
+#endif
@@ -0,0 +1,268 @@
+// Microbenchmarks for the primitives on the hot paths of the proof-of-work simulation: hashing, mining, Merkle trees, serialization,
+// the shared transaction pool, the messages between nodes and difficulty retargeting.
+// Build together with the Proof-of-Work sources other than Simulation.cpp, Monitor.cpp and Benchmark.cpp (this file provides main and the constants).
+// Results are written as JSON to the file given as the first argument, or to the console.
+#include <vector>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <atomic>
+#include <random>
+#include <string>
+#include <ctime>
+
+#include "Measure.h"
+#include "../Proof-of-Work/SHA256.h"
+#include "../Proof-of-Work/Block.h"
+#include "../Proof-of-Work/MerkleTree.h"
+#include "../Proof-of-Work/Transaction.h"
+#include "../Proof-of-Work/Network.h"
+#include "../Proof-of-Work/Node.h"
+#include "../Proof-of-Work/Semaphore.h"
+#include "../Proof-of-Work/Serialization.h"
+#include "../Proof-of-Work/DifficultyEngine.h"
+
+/* Constants required by the Proof-of-Work sources */
+extern const int BLOCK_SIZE = 5;
+extern const int BLOCK_TIME = 10;
+extern const int INITIAL_DIFFICULTY = 2;
+extern const int ADJUSTMENT_FREQUENCY = 20;
+extern const char* const DIFFICULTY_ALGORITHM = "lwma";
+extern const double TRANSACTION_FREQUENCY = 0.1;
+extern const char* const LOAD_PROFILE = "constant";
+extern const unsigned GENERATOR_THREADS = 1;
+extern const unsigned GENERATION_BATCH = 1024;
+extern const unsigned POOL_SHARDS = 32;
+extern const double BURST_SECONDS = 1.0;
+extern const double IDLE_SECONDS = 4.0;
+extern const char* const TRACE_FILE = "trace.bin";
+extern const double TRACE_SPEED = 1.0;
+extern const int CONFIRMATION_DEPTH = 5;
+extern const int SYNCHRONIZATION_THRESHOLD = 30;
+extern const int SYNCHRONIZATION_FREQUENCY = 20;
+extern const unsigned AVAILABLE_CONTEXTS = 1;
+extern const int TRANSACTIONS_TO_SHOW = 20;
+extern const bool BINARY_HASH = false;
+extern const char* const TIMELINE_FILE = "";
+extern const unsigned TIMELINE_CAPACITY = 65536;
+extern const bool LOCK_STATISTICS = false;
+extern const bool PERF_COUNTERS = false;
+extern const char* const PLACEMENT = "none";
+extern const int SYNCHRONIZATION_BATCH = 8;
+extern const bool COMPACT_BLOCKS = true;
+extern const unsigned VALIDATION_THREADS = 1;
+extern const char* const MINING_THREADS = "1";
+extern const unsigned MINING_CHECK_INTERVAL = 1024;
+
+std::vector<Transaction> randomTransactions(int count, std::mt19937_64& rng) {
+	std::uniform_int_distribution<unsigned int> dist(1, 100000);
+	std::vector<Transaction> transactions;
+	for (int i = 0; i < count; i++) {
+		transactions.push_back(Transaction(i, dist(rng), dist(rng)));
+	}
+	return transactions;
+}
+
+void benchmarkHashing() {
+	for (long long bytes : { 32, 64, 256, 1024, 4096 }) {
+		std::string data(static_cast<size_t>(bytes), 'a');
+		measure("sha256", { { "bytes", bytes } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				data[i % bytes] = static_cast<char>(i);
+				sink += sha256(data)[0];
+			}
+			return n;
+		});
+	}
+}
+
+void benchmarkBlocks(std::mt19937_64& rng) {
+
+	// a difficulty no hash can meet, so every call to mine is a single attempt
+	Block candidate(sha256("previous"), randomTransactions(BLOCK_SIZE, rng), Block::fromLeadingZeros(64));
+	measure("Block::mine", { { "block_size", BLOCK_SIZE } }, [&](unsigned long long n) {
+		for (unsigned long long i = 0; i < n; i++) candidate.mine();
+		return n;
+	});
+
+	std::vector<std::string> hashes;
+	for (int i = 0; i < 1024; i++) hashes.push_back(sha256(std::to_string(i)));
+	for (long long difficulty : { 1, 4 }) {
+		measure("Block::isValid", { { "difficulty", difficulty } }, [&](unsigned long long n) {
+			unsigned long long valid = 0;
+			for (unsigned long long i = 0; i < n; i++) valid += Block::isValid(hashes[i % hashes.size()], Block::fromLeadingZeros(static_cast<int>(difficulty)));
+			sink += valid;
+			return n;
+		});
+	}
+}
+
+void benchmarkMerkleTrees(std::mt19937_64& rng) {
+	for (long long size : { 1, 5, 10, 100, 1000 }) {
+		std::vector<Transaction> transactions = randomTransactions(static_cast<int>(size), rng);
+		measure("MerkleTree", { { "block_size", size } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) sink += MerkleTree(transactions).getMerkleRoot().size();
+			return n;
+		});
+	}
+}
+
+void benchmarkSerialization(std::mt19937_64& rng) {
+	std::vector<Transaction> single = randomTransactions(1, rng);
+	measure("Transaction::toString", {}, [&](unsigned long long n) {
+		for (unsigned long long i = 0; i < n; i++) {
+			single[0].input = static_cast<unsigned int>(i);
+			sink += single[0].toString()[0];
+		}
+		return n;
+	});
+
+	for (long long size : { 5, 100, 1000 }) {
+		Block block(sha256("previous"), randomTransactions(static_cast<int>(size), rng), 1);
+		while (!block.mine());
+		measure("Block::serialize", { { "block_size", size } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				std::vector<unsigned char> bytes;
+				block.serialize(bytes);
+				sink += bytes.size();
+			}
+			return n;
+		});
+
+		measure("Block::serializeCompact", { { "block_size", size } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				std::vector<unsigned char> bytes;
+				block.serializeCompact(bytes, {});
+				sink += bytes.size();
+			}
+			return n;
+		});
+
+		std::vector<unsigned char> bytes;
+		block.serialize(bytes);
+		measure("BlockView::toBlock", { { "block_size", size } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				BlockView view(bytes);
+				sink += view.toBlock(view.decodeTransactions()).transactions.ids.size();
+			}
+			return n;
+		});
+	}
+}
+
+void benchmarkPool() {
+	const unsigned poolSize = 100000;
+	for (unsigned threads : THREAD_COUNTS) {
+
+		// miners collecting a transaction and dropping it again, as happens whenever a competing block arrives
+		Network network;
+		for (unsigned i = 0; i < poolSize; i++) network.addTransaction(i, i);
+		measure("Network::getTransaction+dropTransaction", { { "threads", threads } }, [&](unsigned long long n) {
+			return concurrently(threads, [&](unsigned thread) {
+				unsigned long long i;
+				for (i = 0; i < n; i++) {
+					Transaction* t = network.getTransaction(thread);
+					network.dropTransaction(t->id, thread);
+				}
+				return i;
+			});
+		});
+
+		// every miner confirming the same blocks, as they do once the blocks reach the confirmation depth
+		measure("Network::confirmTransactions", { { "threads", threads }, { "block_size", BLOCK_SIZE } }, [&](unsigned long long n) {
+			Network confirming;
+			for (unsigned long long i = 0; i < n * BLOCK_SIZE; i++) confirming.addTransaction(0, 0);
+			return concurrently(threads, [&](unsigned) {
+				unsigned long long blocks;
+				for (blocks = 0; blocks < n; blocks++) {
+					std::vector<unsigned> ids;
+					for (int j = 0; j < BLOCK_SIZE; j++) ids.push_back(static_cast<unsigned>(blocks * BLOCK_SIZE + j));
+					confirming.confirmTransactions(ids);
+				}
+				return blocks * BLOCK_SIZE;
+			});
+		});
+	}
+}
+
+// the load generator adds due transactions to the pool in batches, taking each shard's lock once per batch
+void benchmarkGeneration() {
+	for (long long size : { 1, 64, 1024 }) {
+		measure("Network::addTransactions", { { "batch", size } }, [&](unsigned long long n) {
+			Network network;
+			std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> batch(static_cast<size_t>(size), std::make_tuple(1u, 2u, 0u));
+			unsigned long long added;
+			for (added = 0; added < n; added += size) network.addTransactions(batch);
+			return added;
+		});
+	}
+}
+
+// reaches Node::post, which nodes only call on themselves
+class MessageBenchmark {
+
+public:
+
+	static void post(Node& from, int to, std::tuple<Semaphore, int, int> message) {
+		from.post(to, message);
+	}
+};
+
+// every thread is a node telling the next that it has found a block, as each node does for all the others
+// the queues are not emptied, so messages are only appended as when a node is busy synchronizing
+void benchmarkMessages() {
+	for (unsigned threads : THREAD_COUNTS) {
+		measure("Node::post", { { "threads", threads } }, [&](unsigned long long n) {
+			Network network;
+			std::vector<std::vector<std::tuple<Semaphore, int, int>>> semaphores(threads);
+			std::vector<WorkEpoch> epochs(threads);
+			std::vector<BlockRequests> requests(threads);
+			std::map<int, std::vector<unsigned char>> sharedBlocks;
+			std::vector<std::unique_ptr<Node>> nodes;
+			for (unsigned i = 0; i < threads; i++) nodes.emplace_back(new Node(i, network, semaphores, epochs, requests, sharedBlocks));
+			return concurrently(threads, [&](unsigned thread) {
+				for (unsigned long long i = 0; i < n; i++) {
+					MessageBenchmark::post(*nodes[thread], (thread + 1) % threads, std::make_tuple(Semaphore::BlockFound, thread, static_cast<int>(i)));
+				}
+				return n;
+			});
+		});
+	}
+}
+
+// a node retargets after every block it adds, and again from the height of each block replaced after a fork
+void benchmarkRetargeting(std::mt19937_64& rng) {
+	std::vector<Block> chain;
+	for (int i = 0; i < 1024; i++) {
+		Block block(sha256(std::to_string(i)), randomTransactions(BLOCK_SIZE, rng), Block::fromLeadingZeros(INITIAL_DIFFICULTY));
+		block.timestamp = static_cast<time_t>(i) * BLOCK_TIME * 1000;
+		chain.push_back(block);
+	}
+	for (long long depth : { 1, 16 }) {
+		DifficultyEngine retarget;
+		retarget.update(chain, 0);
+		measure("DifficultyEngine::update+next", { { "replaced_blocks", depth } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				retarget.update(chain, chain.size() - depth);
+				sink += retarget.next();
+			}
+			return n;
+		});
+	}
+}
+
+int main(int argc, char* argv[]) {
+	std::mt19937_64 rng(1);
+
+	benchmarkHashing();
+	benchmarkBlocks(rng);
+	benchmarkMerkleTrees(rng);
+	benchmarkSerialization(rng);
+	benchmarkPool();
+	benchmarkGeneration();
+	benchmarkMessages();
+	benchmarkRetargeting(rng);
+
+	report(argc, argv);
+	return 0;
+}
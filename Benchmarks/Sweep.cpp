@@ -0,0 +1,94 @@
+// Sweep runs bounded benchmarks of both simulations across a range of configurations and collects the results.
+// Each run is a separate process configured through environment variables, so no run inherits the state of another.
+// Usage: Sweep <proof-of-work executable> <dBFT executable> [output file]
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// node counts and block sizes compared, every combination is run for both protocols
+const unsigned NODE_COUNTS[] = { 4, 7, 10 };
+const int BLOCK_SIZES[] = { 5, 20, 100 };
+// every run is bounded by time so that stalled configurations still finish
+const char* SECONDS_PER_RUN = "60";
+
+void setVariable(const char* name, std::string value) {
+#ifdef _WIN32
+	_putenv_s(name, value.c_str());
+#else
+	setenv(name, value.c_str(), 1);
+#endif
+}
+
+// runs the executable and returns the last line it printed, which is its summary
+std::string run(const std::string& executable) {
+	std::string command = "\"" + executable + "\"";
+	FILE* process = popen(command.c_str(), "r");
+	if (process == nullptr) return "";
+
+	std::string line, last;
+	char buffer[4096];
+	while (fgets(buffer, sizeof(buffer), process) != nullptr) {
+		line += buffer;
+		if (line.back() == '\n') {
+			line.pop_back();
+			if (line.size() > 0) last = line;
+			line.clear();
+		}
+	}
+	if (line.size() > 0) last = line;
+	pclose(process);
+	return last;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "usage: Sweep <proof-of-work executable> <dBFT executable> [output file]" << std::endl;
+		return 1;
+	}
+	std::string pow = argv[1];
+	std::string dbft = argv[2];
+
+	setVariable("BENCHMARK_SECONDS", SECONDS_PER_RUN);
+	std::vector<std::string> results;
+	for (unsigned nodes : NODE_COUNTS) {
+		for (int size : BLOCK_SIZES) {
+			setVariable("BLOCK_SIZE", std::to_string(size));
+			setVariable("AVAILABLE_CONTEXTS", std::to_string(nodes));
+			setVariable("NUMBER_OF_NODES", std::to_string(nodes));
+			for (const std::string& executable : { pow, dbft }) {
+				std::cerr << executable << " nodes=" << nodes << " block_size=" << size << std::endl;
+				std::string summary = run(executable);
+
+				// a run that crashed or printed nothing is left out rather than corrupting the output
+				if (summary.size() == 0 || summary.front() != '{') {
+					std::cerr << "  no summary produced" << std::endl;
+					continue;
+				}
+				results.push_back(summary);
+			}
+		}
+	}
+
+	std::stringstream ss;
+	ss << "[\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		ss << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	ss << "]\n";
+
+	if (argc > 3) {
+		std::ofstream out(argv[3]);
+		out << ss.str();
+	}
+	else std::cout << ss.str();
+	return 0;
+}
@@ -0,0 +1,125 @@
+// Microbenchmarks for the shared structures on the hot paths of the dBFT simulation: the broadcast log, the vote aggregator,
+// each bookkeeper's memory of unconfirmed transactions and the incremental Merkle tree of the speaker's proposal.
+// Build together with the dBFT sources other than Simulation.cpp, Monitor.cpp, Node.cpp and Benchmark.cpp (this file provides main and the constants).
+// Results are written as JSON to the file given as the first argument, or to the console.
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <atomic>
+#include <random>
+#include <string>
+
+#include "Measure.h"
+#include "../dBFT/Transaction.h"
+#include "../dBFT/MerkleTree.h"
+#include "../dBFT/Mempool.h"
+#include "../dBFT/Semaphore.h"
+#include "../dBFT/BroadcastLog.h"
+#include "../dBFT/VoteAggregator.h"
+
+/* Constants required by the dBFT sources */
+extern const int BLOCK_SIZE = 5;
+extern const double TRANSACTION_FREQUENCY = 0.1;
+extern const char* const LOAD_PROFILE = "constant";
+extern const unsigned GENERATOR_THREADS = 1;
+extern const unsigned GENERATION_BATCH = 1024;
+extern const unsigned POOL_SHARDS = 32;
+extern const double BURST_SECONDS = 1.0;
+extern const double IDLE_SECONDS = 4.0;
+extern const char* const TRACE_FILE = "trace.bin";
+extern const double TRACE_SPEED = 1.0;
+extern const int TRANSACTIONS_TO_SHOW = 20;
+extern const char* const TIMELINE_FILE = "";
+extern const unsigned TIMELINE_CAPACITY = 65536;
+extern const bool LOCK_STATISTICS = false;
+extern const bool PERF_COUNTERS = false;
+extern const char* const PLACEMENT = "none";
+
+// every thread is a node broadcasting a message, then reading everything the others have written since its last read
+void benchmarkBroadcasts() {
+	for (unsigned threads : THREAD_COUNTS) {
+		measure("BroadcastLog::append+pop", { { "threads", threads } }, [&](unsigned long long n) {
+			BroadcastLog log(threads);
+			unsigned long long total = concurrently(threads, [&](unsigned thread) {
+				std::tuple<Semaphore, int, int, int> message;
+				unsigned long long read = 0;
+				for (unsigned long long i = 0; i < n; i++) {
+					log.append(std::make_tuple(Semaphore::PrepareResponse, static_cast<int>(i), 0, static_cast<int>(thread)));
+					while (log.peek(thread, message)) {
+						log.pop(thread);
+						read++;
+					}
+				}
+				sink += read;
+				return n;
+			});
+			for (unsigned i = 0; i < threads; i++) log.unsubscribe(i);
+			return total;
+		});
+	}
+}
+
+// every thread is a node voting for the proposal of each height, and moving on to the next height once it has
+void benchmarkVotes() {
+	for (unsigned threads : THREAD_COUNTS) {
+		measure("VoteAggregator::record+advance", { { "threads", threads } }, [&](unsigned long long n) {
+			VoteAggregator votes(threads);
+			return concurrently(threads, [&](unsigned thread) {
+				unsigned long long recorded = 0;
+				for (unsigned long long i = 0; i < n; i++) {
+					int height = static_cast<int>(i);
+					recorded += votes.record(height, 0, Semaphore::PrepareResponse, thread);
+					sink += votes.getTally(height, 0)->approved();
+					votes.advance(thread, height + 1);
+				}
+				return recorded;
+			});
+		});
+	}
+}
+
+// a bookkeeper picking the transactions of a proposal, then forgetting them once confirmed as new ones arrive
+void benchmarkMempool() {
+	std::mt19937_64 rng(1);
+	for (long long size : { 1000, 100000 }) {
+		Mempool memory;
+		unsigned int next = 0;
+		for (; next < size; next++) memory.insert(std::make_shared<const Transaction>(next, next, next));
+		measure("Mempool::sample+erase+insert", { { "transactions", size }, { "block_size", BLOCK_SIZE } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				for (const std::shared_ptr<const Transaction>& t : memory.sample(BLOCK_SIZE, rng)) {
+					memory.erase(t->id);
+					memory.insert(std::make_shared<const Transaction>(next, next, next));
+					next++;
+				}
+			}
+			return n;
+		});
+	}
+}
+
+// the speaker appends transactions to its candidate as they arrive and takes the root once it proposes
+void benchmarkMerkleTrees() {
+	for (long long size : { 5, 100, 1000 }) {
+		std::vector<Transaction> transactions;
+		for (unsigned int i = 0; i < size; i++) transactions.push_back(Transaction(i, i, i));
+		measure("MerkleTree::append+getMerkleRoot", { { "block_size", size } }, [&](unsigned long long n) {
+			for (unsigned long long i = 0; i < n; i++) {
+				MerkleTree tree;
+				for (const Transaction& t : transactions) tree.append(t);
+				sink += tree.getMerkleRoot().size();
+			}
+			return n;
+		});
+	}
+}
+
+int main(int argc, char* argv[]) {
+	benchmarkBroadcasts();
+	benchmarkVotes();
+	benchmarkMempool();
+	benchmarkMerkleTrees();
+
+	report(argc, argv);
+	return 0;
+}
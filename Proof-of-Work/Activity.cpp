@@ -0,0 +1,46 @@
+// ActivityState records what a node is doing for the display, and for how long it has done each thing.
+// Transitions are stored in atomics rather than strings so that reading them from other threads needs no lock and no allocation.
+#include <chrono>
+
+#include "Activity.h"
+#include "Timeline.h"
+
+static long long steadyTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* describe(Activity activity) {
+	switch (activity) {
+	case Activity::GettingTransactions: return "GETTING TRANSACTIONS";
+	case Activity::DroppingTransactions: return "DROPPING TRANSACTIONS";
+	case Activity::Mining: return "MINING";
+	case Activity::AddingBlock: return "ADDING BLOCK";
+	case Activity::PublishingBlock: return "PUBLISHING BLOCK";
+	case Activity::RequestingBlock: return "REQUESTING BLOCK";
+	case Activity::ValidatingBlocks: return "VALIDATING BLOCKS";
+	case Activity::CheckingPartition: return "CHECKING PARTITION";
+	case Activity::CalculatingDifficulty: return "CALCULATING DIFFICULTY";
+	case Activity::Synchronizing: return "SYNCHRONIZING";
+	default: return "NONE";
+	}
+}
+
+ActivityState::ActivityState(int node) :node(node) {
+	current = Activity::None;
+	since = steadyTime();
+	for (std::atomic<long long>& s : spent) s = 0;
+}
+
+void ActivityState::set(Activity activity) {
+	long long now = steadyTime();
+	spent[static_cast<int>(current.load())] += now - since;
+	since = now;
+	current = activity;
+	Timeline::activity(node, describe(activity));
+}
+
+double ActivityState::seconds(Activity activity) const {
+	long long total = spent[static_cast<int>(activity)];
+	if (current == activity) total += steadyTime() - since;
+	return total * 1e-9;
+}
@@ -0,0 +1,157 @@
+// Benchmark class drives bounded runs of the simulation, used to compare the capacity of proof-of-work against dBFT.
+// A run ends after a number of blocks or seconds, after which the throughput, confirmation latency and block rate are reported.
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <cmath>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include "Benchmark.h"
+#include "Node.h"
+#include "Activity.h"
+#include "InstrumentedMutex.h"
+#include "PerfCounters.h"
+#include "Network.h"
+
+extern const int BLOCK_SIZE;
+extern const int BLOCK_TIME;
+extern const int INITIAL_DIFFICULTY;
+extern const int CONFIRMATION_DEPTH;
+extern const char* const DIFFICULTY_ALGORITHM;
+extern const unsigned AVAILABLE_CONTEXTS;
+extern const int BENCHMARK_BLOCKS;
+extern const double BENCHMARK_SECONDS;
+
+Benchmark::Benchmark(std::vector<Node*>& nodes, Network& network) :nodes(nodes), network(network) {
+	start = std::chrono::steady_clock::now();
+	cpuStart = cpuTime();
+}
+
+// on Windows std::clock measures wall time, so the process times are read directly
+double Benchmark::cpuTime() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	auto toSeconds = [](FILETIME t) { return ((static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7; };
+	return toSeconds(kernel) + toSeconds(user);
+#else
+	return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+double Benchmark::percentile(const std::vector<time_t>& sorted, double fraction) {
+	if (sorted.size() == 0) return 0;
+	size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+	return static_cast<double>(sorted[index]);
+}
+
+// the genesis block is not counted
+// read while the nodes run, so from their published chains rather than the chains they are changing
+int Benchmark::height() {
+	int highest = 0;
+	for (Node* n : nodes) {
+		int length = static_cast<int>(n->height()) - 1;
+		if (length > highest) highest = length;
+	}
+	return highest;
+}
+
+void Benchmark::await() {
+	while (true) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		InstrumentedMutex::poll(std::cerr);
+		PerfCounters::poll(std::cerr);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (BENCHMARK_BLOCKS > 0 && height() >= BENCHMARK_BLOCKS) break;
+		if (BENCHMARK_SECONDS > 0 && elapsed >= BENCHMARK_SECONDS) break;
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	cpuSeconds = cpuTime() - cpuStart;
+}
+
+std::string Benchmark::summary() {
+	std::vector<time_t> sorted = network.getLatencies();
+	std::sort(sorted.begin(), sorted.end());
+
+	// every node replacing a block counts towards the forks
+	unsigned forks = 0;
+	for (Node* n : nodes) forks += n->forks;
+
+	// hashes wasted on candidate blocks made stale by a message, and how long miners took to notice
+	unsigned long long hashes = 0, staleHashes = 0;
+	long long reactionTime = 0;
+	unsigned reactions = 0;
+	for (Node* n : nodes) {
+		hashes += n->hashes;
+		staleHashes += n->staleHashes;
+		reactionTime += n->reactionTime;
+		reactions += n->reactions;
+	}
+	int blocks = height();
+
+	// the spread of block times on the longest chain shows how steadily the difficulty holds the block rate
+	// the first block is left out, as it is timed from when its node started
+	Node* longest = nodes.front();
+	for (Node* n : nodes) {
+		if (n->blockchain.size() > longest->blockchain.size()) longest = n;
+	}
+	double intervalSum = 0, intervalSquares = 0;
+	size_t intervals = 0;
+	for (size_t h = 2; h < longest->blockchain.size(); h++) {
+		double interval = (longest->blockchain[h].timestamp - longest->blockchain[h - 1].timestamp) / 1000.0;
+		intervalSum += interval;
+		intervalSquares += interval * interval;
+		intervals++;
+	}
+	double intervalMean = (intervals > 0 ? intervalSum / intervals : 0);
+	double intervalDeviation = (intervals > 0 ? std::sqrt(std::max(intervalSquares / intervals - intervalMean * intervalMean, 0.0)) : 0);
+
+	std::stringstream ss;
+	ss << "{\"protocol\": \"PoW\"";
+	ss << ", \"nodes\": " << AVAILABLE_CONTEXTS;
+	ss << ", \"mining_threads\": [";
+	for (size_t i = 0; i < nodes.size(); i++) ss << (i > 0 ? ", " : "") << nodes[i]->miningThreads;
+	ss << "]";
+	ss << ", \"block_size\": " << BLOCK_SIZE;
+	ss << ", \"block_time\": " << BLOCK_TIME;
+	ss << ", \"initial_difficulty\": " << INITIAL_DIFFICULTY;
+	ss << ", \"difficulty_algorithm\": \"" << DIFFICULTY_ALGORITHM << "\"";
+	ss << ", \"confirmation_depth\": " << CONFIRMATION_DEPTH;
+	ss << ", \"seconds\": " << seconds;
+	ss << ", \"blocks\": " << blocks;
+	ss << ", \"blocks_per_minute\": " << blocks * 60 / seconds;
+	ss << ", \"confirmed_transactions\": " << sorted.size();
+	ss << ", \"transactions_per_second\": " << sorted.size() / seconds;
+	ss << ", \"latency_ms\": {\"p50\": " << percentile(sorted, 0.5) << ", \"p99\": " << percentile(sorted, 0.99) << ", \"p999\": " << percentile(sorted, 0.999) << "}";
+	ss << ", \"block_interval_s\": {\"mean\": " << intervalMean << ", \"cv\": " << (intervalMean > 0 ? intervalDeviation / intervalMean : 0) << "}";
+	ss << ", \"final_difficulty_bits\": " << static_cast<double>(longest->blockchain.back().difficulty) / Block::WORK_SCALE;
+	ss << ", \"forks\": " << forks;
+	ss << ", \"hashes\": " << hashes;
+	ss << ", \"stale_hashes\": " << staleHashes;
+	ss << ", \"reaction_us\": " << (reactions > 0 ? reactionTime / 1000.0 / reactions : 0);
+	ss << ", \"bytes_sent\": " << network.bytesSent.load();
+	// time spent by all nodes in each activity, showing where their time goes
+	ss << ", \"activity_seconds\": {";
+	for (int a = 0; a < static_cast<int>(Activity::Count); a++) {
+		double total = 0;
+		for (Node* n : nodes) total += n->activity.seconds(static_cast<Activity>(a));
+		ss << (a > 0 ? ", " : "") << "\"" << describe(static_cast<Activity>(a)) << "\": " << total;
+	}
+	ss << "}";
+	ss << ", \"cpu_seconds\": " << cpuSeconds;
+	if (PerfCounters::enabled()) {
+		PerfSample mining = PerfCounters::read("node");
+		ss << ", \"perf\": " << PerfCounters::summary();
+		ss << ", \"cycles_per_hash\": " << (hashes > 0 ? static_cast<double>(mining.cycles) / hashes : 0);
+	}
+	ss << "}";
+	return ss.str();
+}
@@ -0,0 +1,42 @@
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "Node.h"
+#include "Network.h"
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// runs the simulation for a fixed number of blocks or seconds and summarises its performance
+class Benchmark {
+
+private:
+
+	std::vector<Node*>& nodes;
+	Network& network;
+
+	std::chrono::steady_clock::time_point start;
+	double cpuStart;
+	double seconds = 0; // wall time of the run
+	double cpuSeconds = 0; // processor time of all threads during the run
+
+	// the height of the longest chain
+	int height();
+
+public:
+
+	Benchmark(std::vector<Node*>& nodes, Network& network);
+
+	// returns once BENCHMARK_BLOCKS blocks have been mined or BENCHMARK_SECONDS have passed
+	void await();
+	// summary of the run as a JSON object
+	std::string summary();
+
+	// processor time used by the process so far, in seconds
+	static double cpuTime();
+	// the value below which the given fraction of the sorted values fall
+	static double percentile(const std::vector<time_t>& sorted, double fraction);
+};
+
+#endif
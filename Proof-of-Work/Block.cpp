@@ -2,50 +2,109 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cmath>
 
 #include "Block.h"
 #include "MerkleTree.h"
 #include "Transaction.h"
 #include "SHA256.h"
+#include "Serialization.h"
 
 extern const int INITIAL_DIFFICULTY;
 extern const bool BINARY_HASH;
 
-bool Block::isValid(std::string hash, int difficulty) {
-	// check leading zeros of the hash
-	int i = 0;
-	while (i < difficulty) {
-		if (BINARY_HASH) {
-			if (hash[i] > '7') return false;
-		}
-		else if (hash[i] != '0') return false;
-		i++;
+int Block::fromLeadingZeros(int zeros) {
+	return zeros * (BINARY_HASH ? 1 : 4) * WORK_SCALE;
+}
+
+// a whole number of leading zero characters gives the same condition as checking the characters themselves
+bool Block::isValid(const std::string& hash, int difficulty) {
+	if (difficulty <= 0) return true;
+	if (difficulty >= 64 * WORK_SCALE) return false;
+
+	// miners check many hashes against the same difficulty, so the target is only recomputed when it changes
+	thread_local int cachedDifficulty = 0;
+	thread_local unsigned long long target = 0;
+	if (difficulty != cachedDifficulty) {
+		target = static_cast<unsigned long long>(std::exp2(64 - static_cast<double>(difficulty) / WORK_SCALE));
+		cachedDifficulty = difficulty;
+	}
+
+	// read a character at a time, most hashes fail on the first
+	// the digit is computed without branching on whether it is a letter, which would be mispredicted half the time
+	unsigned long long prefix = 0;
+	for (int i = 0; i < 16; i++) {
+		unsigned char c = static_cast<unsigned char>(hash[i]);
+		prefix = (prefix << 4) | ((c & 0xf) + 9 * (c >> 6));
+		if ((prefix << (60 - 4 * i)) >= target) return false;
 	}
 	return true;
 }
 
 // produces a genesis block with a dummy coinbase transaction (if tracking all nodes' balance, this transaction would credit this node with all initial currency)
-Block::Block():transactions({Transaction(0, 0, 0)}){
+Block::Block():transactions({Transaction(0, 0, 0)}), body({Transaction(0, 0, 0)}){
 	nonce = 0;
-	difficulty = INITIAL_DIFFICULTY;
+	difficulty = fromLeadingZeros(INITIAL_DIFFICULTY);
 	previousHash = "0000000000000000000000000000000000000000000000000000000000000000";
 
 	// calculate the hash of the first block
 	while (!mine());
 }
 
-Block::Block(std::string previousHash, std::vector<Transaction> transactions, int difficulty) :previousHash(previousHash), transactions(transactions), difficulty(difficulty) {
+Block::Block(std::string previousHash, std::vector<Transaction> transactions, int difficulty) :previousHash(previousHash), transactions(transactions), body(transactions), difficulty(difficulty) {
 	nonce = 0;
 }
 
+void Block::serializeHeader(std::vector<unsigned char>& bytes) const {
+	const std::string& root = transactions.hashes.back();
+	size_t rootLength = (root.size() < 255 ? root.size() : 255);
+
+	bytes.push_back(WIRE_VERSION);
+	putInteger(bytes, static_cast<uint64_t>(timestamp), 8);
+	putInteger(bytes, nonce, 8);
+	putInteger(bytes, static_cast<uint32_t>(difficulty), 4);
+	putHash(bytes, previousHash);
+	putHash(bytes, hash);
+	bytes.push_back(static_cast<unsigned char>(rootLength));
+	bytes.insert(bytes.end(), root.begin(), root.begin() + rootLength);
+}
+
+void Block::serialize(std::vector<unsigned char>& bytes) const {
+	serializeHeader(bytes);
+	putInteger(bytes, body.size(), 4);
+	bytes.push_back(0);
+
+	size_t position = bytes.size();
+	bytes.resize(position + TransactionView::SIZE * body.size());
+	for (const Transaction& t : body) {
+		t.serialize(&bytes[position]);
+		position += TransactionView::SIZE;
+	}
+}
+
+void Block::serializeCompact(std::vector<unsigned char>& bytes, const std::vector<Transaction>& prefilled) const {
+	serializeHeader(bytes);
+	putInteger(bytes, body.size(), 4);
+	bytes.push_back(1);
+	for (const Transaction& t : body) putInteger(bytes, t.id, 4);
+
+	putInteger(bytes, prefilled.size(), 4);
+	size_t position = bytes.size();
+	bytes.resize(position + TransactionView::SIZE * prefilled.size());
+	for (const Transaction& t : prefilled) {
+		t.serialize(&bytes[position]);
+		position += TransactionView::SIZE;
+	}
+}
+
 // this is where proof-of-work happens
-bool Block::mine() {
-	nonce++;
+bool Block::mine(unsigned long long stride) {
+	nonce += stride;
 
 	// concatenate and hash the block data
 	hash = sha256(previousHash + transactions.getMerkleRoot() + std::to_string(nonce));
 
-	// check leading zeros of the hash
+	// check the hash meets the difficulty
 	if (!isValid(hash, difficulty)) return false;
 
 	// record when the block is solved
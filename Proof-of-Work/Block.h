@@ -15,14 +15,28 @@ public:
 	unsigned long long int nonce;
 	std::string previousHash;
 	MerkleTree transactions;
+	std::vector<Transaction> body; // the transactions themselves, in the order of the tree's leaves
 	std::string hash;
-	int difficulty;
+	int difficulty; // log2 of the number of hashes expected to find the block, in units of 1 / WORK_SCALE
+
+	// fine enough that retargeting can move the difficulty by fractions of a leading zero
+	static const int WORK_SCALE = 65536;
 
 	Block();
 	Block(std::string previousBlockHash, std::vector<Transaction> transactions, int difficulty);
 
-	static bool isValid(std::string hash, int difficulty);
-	bool mine();
+	// the difficulty of requiring this many leading zeros, counted in hexadecimal characters or in bits with BINARY_HASH
+	static int fromLeadingZeros(int zeros);
+	// the first 64 bits of the hash must be below 2^64 / 2^(difficulty / WORK_SCALE)
+	static bool isValid(const std::string& hash, int difficulty);
+	// moves the nonce on by stride and checks the resulting hash
+	bool mine(unsigned long long stride = 1);
+
+	// appends the binary encoding of the block (see Serialization.h), or only of its header
+	void serialize(std::vector<unsigned char>& bytes) const;
+	void serializeHeader(std::vector<unsigned char>& bytes) const;
+	// identifies the transactions rather than including them, other than those the receiver is not expected to have
+	void serializeCompact(std::vector<unsigned char>& bytes, const std::vector<Transaction>& prefilled) const;
 
 };
 
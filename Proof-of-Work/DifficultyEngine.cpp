@@ -0,0 +1,104 @@
+// DifficultyEngine class retargets the proof-of-work after every block, so that blocks keep arriving every BLOCK_TIME as miners come and go.
+// Difficulties are fine-grained (see Block.h), so the per-block algorithms move them by fractions of a leading zero rather than 16x steps.
+#include <vector>
+#include <string>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+
+#include "DifficultyEngine.h"
+#include "Block.h"
+
+extern const int BLOCK_TIME;
+extern const int ADJUSTMENT_FREQUENCY;
+extern const bool BINARY_HASH;
+extern const char* const DIFFICULTY_ALGORITHM;
+
+DifficultyEngine::DifficultyEngine() :algorithm(parseAlgorithm(DIFFICULTY_ALGORITHM)), window(std::max(ADJUSTMENT_FREQUENCY, 2)), blockTime(BLOCK_TIME) {}
+
+RetargetAlgorithm DifficultyEngine::parseAlgorithm(const std::string& name) {
+	if (name == "step") return RetargetAlgorithm::Step;
+	if (name == "asert") return RetargetAlgorithm::ASERT;
+	return RetargetAlgorithm::LWMA;
+}
+
+int DifficultyEngine::toDifficulty(double bits) {
+	return static_cast<int>(std::lround(bits * Block::WORK_SCALE));
+}
+
+double DifficultyEngine::toBits(int difficulty) {
+	return static_cast<double>(difficulty) / Block::WORK_SCALE;
+}
+
+// normally a single block is appended, a longer chain received from another node replaces the blocks from where they diverge
+void DifficultyEngine::update(const std::vector<Block>& chain, size_t height) {
+	size_t kept = std::min(height, timestamps.size());
+	timestamps.resize(kept);
+	difficulties.resize(kept);
+	work.resize(kept);
+	solveTimes.resize(kept);
+	weightedSolveTimes.resize(kept);
+
+	for (size_t h = kept; h < chain.size(); h++) {
+		const Block& block = chain[h];
+
+		// solve times are bounded so that a block with a skewed timestamp cannot swing lwma on its own, step and asert read the timestamps
+		double solveTime = (h == 0 ? 0 : std::min(std::max((block.timestamp - timestamps[h - 1]) / 1000.0, 0.0), 6 * blockTime));
+		double previous = (h == 0 ? 0 : solveTimes[h - 1]);
+		double previousWeighted = (h == 0 ? 0 : weightedSolveTimes[h - 1]);
+
+		timestamps.push_back(block.timestamp);
+		difficulties.push_back(block.difficulty);
+		work.push_back((h == 0 ? 0 : work[h - 1]) + std::exp2(toBits(block.difficulty)));
+		solveTimes.push_back(previous + solveTime);
+		weightedSolveTimes.push_back(previousWeighted + h * solveTime);
+	}
+}
+
+int DifficultyEngine::next() const {
+	if (timestamps.empty()) return Block::fromLeadingZeros(0);
+	size_t tip = timestamps.size() - 1;
+	if (tip == 0) return difficulties[0];
+	switch (algorithm) {
+	case RetargetAlgorithm::Step: return step(tip);
+	case RetargetAlgorithm::ASERT: return asert(tip);
+	default: return lwma(tip);
+	}
+}
+
+double DifficultyEngine::chainWork() const {
+	return (work.empty() ? 0 : work.back());
+}
+
+// the original scheme: the average of the solve times since the last adjustment decides whether a leading zero is added or removed
+int DifficultyEngine::step(size_t tip) const {
+	if (tip % window != 0) return difficulties[tip];
+
+	// from the timestamps themselves, since the solve times are bounded for the per-block algorithms only
+	size_t first = tip - (window - 1);
+	double averageTime = (timestamps[tip] - timestamps[first]) / 1000.0 / (window - 1);
+	return difficulties[tip] + (averageTime < blockTime ? 1 : -1) * Block::fromLeadingZeros(1);
+}
+
+// the average work of the window scaled by how far the weighted average solve time is from BLOCK_TIME
+// recent blocks weigh the most, so the difficulty responds quickly without overshooting
+int DifficultyEngine::lwma(size_t tip) const {
+	size_t n = std::min(static_cast<size_t>(window), tip);
+	size_t before = tip - n;
+
+	// with weights 1 to n from the oldest block of the window, the sum of height * solve time overcounts by before * solve time
+	double weighted = (weightedSolveTimes[tip] - weightedSolveTimes[before]) - before * (solveTimes[tip] - solveTimes[before]);
+	double ideal = blockTime * n * (n + 1) / 2;
+	double averageWork = (work[tip] - work[before]) / n;
+
+	// at most doubles or halves per block, and a window of instant blocks cannot make it infinite
+	double change = std::log2(ideal / std::max(weighted, ideal / 1000));
+	return toDifficulty(std::log2(averageWork) + std::min(std::max(change, -1.0), 1.0));
+}
+
+// the difficulty depends only on how far the tip is ahead of or behind the schedule set from the genesis block
+int DifficultyEngine::asert(size_t tip) const {
+	// the schedule starts at the genesis block's own timestamp, so tip blocks have been mined since
+	double ahead = blockTime * tip - (timestamps[tip] - timestamps[0]) / 1000.0;
+	return toDifficulty(toBits(difficulties[0]) + ahead / (blockTime * window));
+}
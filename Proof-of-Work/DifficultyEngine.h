@@ -0,0 +1,55 @@
+#include <vector>
+#include <string>
+#include <ctime>
+
+#include "Block.h"
+
+#ifndef DIFFICULTYENGINE_H
+#define DIFFICULTYENGINE_H
+
+// ways of choosing the difficulty of the next block
+enum class RetargetAlgorithm {
+	Step, // one leading zero up or down every ADJUSTMENT_FREQUENCY blocks, depending on their average time
+	LWMA, // every block, from the linearly weighted moving average of the last ADJUSTMENT_FREQUENCY solve times
+	ASERT // every block, exponentially from the genesis block's difficulty, halving or doubling per ADJUSTMENT_FREQUENCY block times ahead or behind
+};
+
+// follows a node's blockchain and chooses the difficulty of the block to be mined on top of it
+// sums over the chain are kept by height, so that any window is summarised by subtracting two of them
+// and following a new block, or a block replaced after a fork, takes constant time
+class DifficultyEngine {
+
+private:
+
+	const RetargetAlgorithm algorithm;
+	const int window; // blocks
+	const double blockTime; // seconds
+
+	std::vector<time_t> timestamps;
+	std::vector<int> difficulties;
+	std::vector<double> work; // expected hashes of the blocks up to each height
+	std::vector<double> solveTimes; // seconds taken to mine the blocks up to each height, each bounded for lwma
+	std::vector<double> weightedSolveTimes; // as above, each weighted by its height
+
+	// log2 of the expected hashes as a difficulty
+	static int toDifficulty(double bits);
+	static double toBits(int difficulty);
+	int step(size_t tip) const;
+	int lwma(size_t tip) const;
+	int asert(size_t tip) const;
+
+public:
+
+	DifficultyEngine();
+
+	static RetargetAlgorithm parseAlgorithm(const std::string& name);
+
+	// brings the sums in line with the chain from the given height, which has been added or replaced
+	void update(const std::vector<Block>& chain, size_t height);
+	// the difficulty of the block to be mined on top of the chain
+	int next() const;
+	// expected hashes to mine the whole chain
+	double chainWork() const;
+};
+
+#endif
@@ -0,0 +1,182 @@
+// InstrumentedMutex class measures contention on the locks guarding shared state, to find which of them hold the simulation back.
+// Call sites are recorded as return addresses, reported relative to the executable so that they can be looked up with addr2line.
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <csignal>
+#ifdef _WIN32
+#include <intrin.h>
+#pragma intrinsic(_ReturnAddress)
+#define RETURN_ADDRESS() _ReturnAddress()
+#else
+#include <dlfcn.h>
+#define RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+#include "InstrumentedMutex.h"
+
+extern const bool LOCK_STATISTICS;
+
+static volatile std::sig_atomic_t reportRequested = 0;
+
+InstrumentedMutex::InstrumentedMutex(const char* name) :name(name) {
+	std::lock_guard<std::mutex> lock(registryLock());
+	registry().push_back(this);
+}
+
+InstrumentedMutex::~InstrumentedMutex() {
+	std::lock_guard<std::mutex> lock(registryLock());
+	std::vector<InstrumentedMutex*>& all = registry();
+	all.erase(std::remove(all.begin(), all.end(), this), all.end());
+}
+
+// function statics, as some of the mutexes are themselves statics constructed in other files
+std::vector<InstrumentedMutex*>& InstrumentedMutex::registry() {
+	static std::vector<InstrumentedMutex*> all;
+	return all;
+}
+
+std::mutex& InstrumentedMutex::registryLock() {
+	static std::mutex lock;
+	return lock;
+}
+
+long long InstrumentedMutex::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int InstrumentedMutex::bucket(long long nanoseconds) {
+	int i = 0;
+	while (i < BUCKETS - 1 && (1LL << i) <= nanoseconds) i++;
+	return i;
+}
+
+void InstrumentedMutex::lock() {
+	if (!LOCK_STATISTICS) {
+		m.lock();
+		return;
+	}
+	long long requested = now();
+	bool wasContended = !m.try_lock();
+	if (wasContended) m.lock();
+	acquire(RETURN_ADDRESS(), requested, wasContended);
+}
+
+bool InstrumentedMutex::try_lock() {
+	if (!m.try_lock()) return false;
+	if (LOCK_STATISTICS) acquire(RETURN_ADDRESS(), now(), false);
+	return true;
+}
+
+void InstrumentedMutex::unlock() {
+	if (LOCK_STATISTICS) {
+		long long duration = now() - acquired;
+		statistics.held += duration;
+		statistics.holds[bucket(duration)]++;
+	}
+	m.unlock();
+}
+
+// called with the mutex held
+void InstrumentedMutex::acquire(const void* site, long long requested, bool wasContended) {
+	acquired = now();
+	long long wait = acquired - requested;
+	statistics.acquisitions++;
+	statistics.waited += wait;
+	statistics.waits[bucket(wait)]++;
+	if (!wasContended) return;
+	statistics.contended++;
+
+	// keep the call sites that find the mutex taken most often
+	Site* least = &statistics.sites[0];
+	for (Site& s : statistics.sites) {
+		if (s.address == site) {
+			s.contended++;
+			s.waited += wait;
+			return;
+		}
+		if (s.contended < least->contended) least = &s;
+	}
+	*least = { site, 1, wait };
+}
+
+void InstrumentedMutex::describe(std::ostream& out, const char* name, const Statistics& statistics) {
+	const Statistics& s = statistics;
+
+	// percentiles are given as the upper bound of the bucket they fall in
+	auto percentile = [](const unsigned long long* histogram, unsigned long long total, double fraction) {
+		unsigned long long seen = 0;
+		for (int i = 0; i < BUCKETS; i++) {
+			seen += histogram[i];
+			if (seen > 0 && seen >= fraction * total) return 1LL << i;
+		}
+		return 0LL;
+	};
+	auto histogram = [&out](const char* label, const unsigned long long* buckets) {
+		out << "  " << label << " histogram (under ns: count):";
+		for (int i = 0; i < BUCKETS; i++) if (buckets[i] > 0) out << " " << (1LL << i) << ": " << buckets[i];
+		out << "\n";
+	};
+
+	out << name << ": " << s.acquisitions << " acquisitions, " << s.contended << " contended ("
+		<< std::fixed << std::setprecision(2) << (s.acquisitions > 0 ? 100.0 * s.contended / s.acquisitions : 0) << "%), waited "
+		<< s.waited / 1e6 << " ms, held " << s.held / 1e6 << " ms\n";
+	out << "  wait p50 < " << percentile(s.waits, s.acquisitions, 0.5) << " ns, p99 < " << percentile(s.waits, s.acquisitions, 0.99)
+		<< " ns; hold p50 < " << percentile(s.holds, s.acquisitions, 0.5) << " ns, p99 < " << percentile(s.holds, s.acquisitions, 0.99) << " ns\n";
+	histogram("wait", s.waits);
+	histogram("hold", s.holds);
+
+	std::vector<Site> contenders(s.sites, s.sites + SITES);
+	std::sort(contenders.begin(), contenders.end(), [](const Site& a, const Site& b) { return a.contended > b.contended; });
+	for (const Site& site : contenders) {
+		if (site.contended == 0) continue;
+		out << "  contended at ";
+#ifdef _WIN32
+		out << site.address;
+#else
+		Dl_info info;
+		if (dladdr(site.address, &info) != 0 && info.dli_fname != nullptr) {
+			out << info.dli_fname << "+0x" << std::hex << (static_cast<const char*>(site.address) - static_cast<const char*>(info.dli_fbase)) << std::dec;
+		}
+		else out << site.address;
+#endif
+		out << ": " << site.contended << " times, waited " << site.waited / 1e6 << " ms\n";
+	}
+}
+
+void InstrumentedMutex::report(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(registryLock());
+
+	// each mutex is reported from a copy of its statistics taken while holding it
+	std::vector<std::pair<const char*, Statistics>> copies;
+	for (InstrumentedMutex* mutex : registry()) {
+		mutex->m.lock();
+		copies.push_back(std::make_pair(mutex->name, mutex->statistics));
+		mutex->m.unlock();
+	}
+	std::sort(copies.begin(), copies.end(), [](const std::pair<const char*, Statistics>& a, const std::pair<const char*, Statistics>& b) {
+		return a.second.waited > b.second.waited;
+	});
+
+	out << "Lock statistics\n";
+	for (const std::pair<const char*, Statistics>& copy : copies) describe(out, copy.first, copy.second);
+	out.flush();
+}
+
+static void requestReport(int) {
+	reportRequested = 1;
+}
+
+void InstrumentedMutex::listen() {
+#ifndef _WIN32
+	std::signal(SIGUSR1, requestReport);
+#endif
+}
+
+void InstrumentedMutex::poll(std::ostream& out) {
+	if (!reportRequested) return;
+	reportRequested = 0;
+	report(out);
+}
@@ -0,0 +1,67 @@
+#include <mutex>
+#include <vector>
+#include <ostream>
+
+#ifndef INSTRUMENTEDMUTEX_H
+#define INSTRUMENTEDMUTEX_H
+
+// a mutex that records, when LOCK_STATISTICS is set, how often it is taken, how long threads wait for it and hold it,
+// and the call sites that most often find it taken, so that contention on the shared locks can be measured
+// the statistics are updated while the mutex is held so need no synchronisation of their own
+// otherwise it behaves as a std::mutex (and can be used with std::lock_guard) apart from a check of the flag
+class InstrumentedMutex {
+
+private:
+
+	static const int BUCKETS = 40; // histogram buckets, bucket i counts times under 2^i nanoseconds
+	static const int SITES = 8; // contended call sites kept, the least contended is replaced when a new one is seen
+
+	struct Site {
+		const void* address; // return address of the call to lock()
+		unsigned long long contended;
+		long long waited; // nanoseconds
+	};
+
+	struct Statistics {
+		unsigned long long acquisitions = 0;
+		unsigned long long contended = 0; // acquisitions that had to wait
+		long long waited = 0; // nanoseconds
+		long long held = 0;
+		unsigned long long waits[BUCKETS] = {};
+		unsigned long long holds[BUCKETS] = {};
+		Site sites[SITES] = {};
+	};
+
+	std::mutex m;
+	const char* name;
+	Statistics statistics;
+	long long acquired = 0; // when the current holder took the mutex
+
+	// every instrumented mutex, so that they can all be reported
+	static std::vector<InstrumentedMutex*>& registry();
+	static std::mutex& registryLock();
+
+	static long long now();
+	static int bucket(long long nanoseconds);
+	void acquire(const void* site, long long requested, bool wasContended);
+	static void describe(std::ostream& out, const char* name, const Statistics& statistics);
+
+public:
+
+	InstrumentedMutex(const char* name);
+	~InstrumentedMutex();
+	InstrumentedMutex(const InstrumentedMutex&) = delete;
+	InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+	void lock();
+	bool try_lock();
+	void unlock();
+
+	// writes the statistics of every instrumented mutex, those waited for longest first
+	static void report(std::ostream& out);
+	// on POSIX systems SIGUSR1 requests a report, which is written the next time poll is called
+	static void listen();
+	static void poll(std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include <vector>
+#include <random>
+#include <string>
+#include <chrono>
+#include <memory>
+
+#include "Network.h"
+#include "TraceFile.h"
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+// shapes of the transaction arrivals
+enum class LoadProfile {
+	Constant, // evenly spaced, one every TRANSACTION_FREQUENCY seconds
+	Poisson, // independent arrivals at the same average rate
+	Bursty, // poisson arrivals during BURST_SECONDS, then none for IDLE_SECONDS, at the same average rate overall
+	Trace // arrivals replayed from TRACE_FILE, TRACE_SPEED times faster than they were recorded
+};
+
+// simulates the users of the network submitting transactions
+// one or more threads each produce their share of the arrivals and add them to the pool in batches
+class LoadGenerator {
+
+private:
+
+	Network& network;
+	const LoadProfile profile;
+	const unsigned threads;
+	const double rate; // transactions per second of each thread
+	std::unique_ptr<TraceFile> trace;
+
+	// loop of a single generating thread
+	void generate(unsigned thread);
+	// loop of a single replaying thread, which replays every threads-th record of the trace
+	void replay(unsigned thread);
+	// time (in seconds since the start) of the arrival following the one at the given time
+	double nextArrival(double previous, std::mt19937_64& rng);
+
+public:
+
+	LoadGenerator(Network& network);
+
+	// generates transactions until the network is stopped
+	void run();
+
+	// false, after reporting why, if the chosen profile cannot generate transactions i.e. the trace cannot be opened
+	static bool available();
+
+	// converts the name given in LOAD_PROFILE, unknown names fall back to a constant rate
+	static LoadProfile parseProfile(const std::string& name);
+};
+
+#endif
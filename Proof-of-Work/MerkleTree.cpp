@@ -13,6 +13,12 @@ MerkleTree::MerkleTree(std::vector<Transaction> transactions) {
 		ids.push_back(t.id);
 	}
 
+	// a block without transactions (e.g. proposed once a replayed trace has ended) has the hash of nothing as its root
+	if (transactions.size() == 0) {
+		hashes.push_back(std::to_string(std::hash<std::string>()("")));
+		return;
+	}
+
 	// as binary trees, Merkle trees need an even number of leaves -> we duplicate the last element if this is not the case
 	if (transactions.size() % 2 == 1) transactions.push_back(transactions.back());
 
@@ -1,16 +1,22 @@
 #include <string>
 #include <sstream>
+#include <iomanip>
+#include <iostream>
 
 #include "Monitor.h"
 #include "Node.h"
 #include "Semaphore.h"
 #include "Network.h"
+#include "InstrumentedMutex.h"
+#include "PerfCounters.h"
+#include "Placement.h"
 
 #include <curses.h>
 
 extern const int BLOCK_SIZE;
 extern const int BLOCK_TIME;
 extern const int ADJUSTMENT_FREQUENCY;
+extern const char* const DIFFICULTY_ALGORITHM;
 extern const double TRANSACTION_FREQUENCY;
 extern const int CONFIRMATION_DEPTH;
 extern const int SYNCHRONIZATION_FREQUENCY;
@@ -26,6 +32,8 @@ Monitor::Monitor(std::vector<std::vector<std::tuple<Semaphore, int, int>>>& sema
 }
 
 void Monitor::display(std::vector<Node*> nodes, Network* network) {
+	Placement::pin("monitor", 0);
+	PerfCounters::attach("monitor", 0);
 
 	// initialize the console for curses
 	initscr();
@@ -67,8 +75,9 @@ void Monitor::display(std::vector<Node*> nodes, Network* network) {
 	mvwprintw(settingsWin, 1, 13, std::to_string(BLOCK_SIZE).c_str());
 	mvwprintw(settingsWin, 2, 1, "Block Frequency: ");
 	mvwprintw(settingsWin, 2, 18, std::to_string(BLOCK_TIME).c_str());
-	mvwprintw(settingsWin, 3, 1, "Difficulty Calculation (blocks): ");
-	mvwprintw(settingsWin, 3, 34, std::to_string(ADJUSTMENT_FREQUENCY).c_str());
+	std::string retarget = std::string("Difficulty (") + DIFFICULTY_ALGORITHM + ", blocks): ";
+	mvwprintw(settingsWin, 3, 1, retarget.c_str());
+	mvwprintw(settingsWin, 3, 1 + static_cast<int>(retarget.size()), std::to_string(ADJUSTMENT_FREQUENCY).c_str());
 	mvwprintw(settingsWin, 4, 1, "Transaction Frequency: ");
 	mvwprintw(settingsWin, 4, 24, std::to_string(TRANSACTION_FREQUENCY).c_str());
 	for (int i = 1; i < 5; i++) mvwprintw(settingsWin, i, settingsColTwo-2, "|");
@@ -84,6 +93,10 @@ void Monitor::display(std::vector<Node*> nodes, Network* network) {
 
 	// continuously update display
 	while (true) {
+
+		// lock statistics and performance counters requested by signal go to the error stream, which should be redirected away from the display
+		InstrumentedMutex::poll(std::cerr);
+		PerfCounters::poll(std::cerr);
 		
 		// get most recently confirmed transactions
 		auto recentConfs = network->recentConfirmations;
@@ -126,7 +139,7 @@ void Monitor::display(std::vector<Node*> nodes, Network* network) {
 			if (blockHeight > 0) workingHash = nodes[i]->blockchain.back().hash;
 			ss << nodes[i]->id;
 			ss << "     " << blockHeight;
-			ss << "     " << nodes[i]->activity;
+			ss << "     " << std::left << std::setw(22) << describe(nodes[i]->activity.current);
 			ss << " \t" << workingHash;
 			mvwprintw(nodesWin, i + 2, 1, ss.str().c_str());
 			ss.str("");
@@ -8,98 +8,133 @@
 #include <iostream>
 
 #include "Network.h"
+#include "LoadGenerator.h"
 #include "Transaction.h"
 #include "MerkleTree.h"
 #include "SHA256.h"
+#include "PerfCounters.h"
+#include "Placement.h"
 
 extern const double TRANSACTION_FREQUENCY;
 extern const int TRANSACTIONS_TO_SHOW;
+extern const unsigned POOL_SHARDS;
 
-Network::Network() {
-	// setup random number generator for transactions
-	std::random_device rd;
-	rng = std::mt19937_64(rd());
+Network::Network() :pool(POOL_SHARDS) {
+	running = true;
+	bytesSent = 0;
 }
 
 // populates the pool of unconfirmed transactions
 void Network::generateTransactions() {
-	std::uniform_int_distribution<unsigned int> dist(1, 100000);
-
-	unsigned int i = 0;
-	while(true){
-		Transaction* t = new Transaction(i, dist(rng), dist(rng));
-		p.lock();
-		pool.push_back(t);
-		p.unlock();
-		i++;
-		std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(TRANSACTION_FREQUENCY * 1000)));
-	}
+	Placement::pin("generator", 0);
+	PerfCounters::attach("generator", 0);
+	LoadGenerator generator(*this);
+	generator.run();
+}
+
+// transaction ids are their index in the pool
+unsigned int Network::addTransaction(unsigned int input, unsigned int output) {
+	Transaction* t = new Transaction(0, input, output);
+	pool.add({ t });
+	return t->id;
+}
+
+// the transactions are created before taking the shard locks so that miners are only held up by the appends
+void Network::addTransactions(const std::vector<std::tuple<unsigned int, unsigned int, unsigned int>>& transfers) {
+	std::vector<Transaction*> batch;
+	batch.reserve(transfers.size());
+	for (auto& transfer : transfers) batch.push_back(new Transaction(0, std::get<0>(transfer), std::get<1>(transfer), std::get<2>(transfer)));
+	pool.add(batch);
 }
 
 // returns distribution used by the RNG
 std::uniform_int_distribution<unsigned long long int> Network::createDistribution(){
 
-	p.lock();
 	unsigned long long int max = pool.size();
-	p.unlock();
 
 	// handles race conditions where a transaction may be requested before any are generated
 	if(max == 0){
-		while(max == 0){
+		while(max == 0 && running){
 			std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(TRANSACTION_FREQUENCY * 1000)));
-			p.lock();
 			max = pool.size();
-			p.unlock();
 		}
 	}
 
 	// ternary used to handle race conditions meaning a transaction is requested before any are generated
-	std::uniform_int_distribution<unsigned long long int> dist(0, max-1);
+	std::uniform_int_distribution<unsigned long long int> dist(0, max == 0 ? 0 : max-1);
 	return dist;
 }
 
 // called when a mining node is listening for transactions
-Transaction& Network::getTransaction(int requester) {
+// each miner draws from its own random number generator, so only the shard of the drawn transaction is locked
+Transaction* Network::getTransaction(int requester) {
+	thread_local std::mt19937_64 rng(std::random_device{}());
 	std::uniform_int_distribution<unsigned long long int> dist;
-	unsigned long long int index;
-	while(true){
+	while(running){
 
 		dist = createDistribution();
-		index = dist(rng);
-		p.lock();
-		Transaction* t = pool[index];
-		p.unlock();
-		if(t != nullptr && !t->collected) {
-			t->collected = true;
-			return *t;
-		}
+		unsigned int index = static_cast<unsigned int>(dist(rng));
+		Transaction* t = pool.with(index, [](Transaction*& entry) -> Transaction* {
+			if (entry == nullptr || entry->collected) return nullptr;
+			entry->collected = true;
+			return entry;
+		});
+		if (t != nullptr) return t;
 	}
+	return nullptr;
 }
 
 // called when a mining node stops mining a block containing a transaction (e.g. if an alternative block is received)
 void Network::dropTransaction(int id, int dropper) {
-	p.lock();
-	Transaction *t = pool[id];
-	if (t != nullptr) {
-		t->collected = false; 
-	}
-	p.unlock();
+	pool.with(id, [](Transaction*& entry) {
+		if (entry != nullptr) entry->collected = false;
+	});
+}
+
+// used to complete compact blocks from the pool
+bool Network::findTransaction(unsigned int id, Transaction& found) {
+	return pool.with(id, [&found](Transaction*& entry) {
+		if (entry == nullptr) return false;
+		found = *entry;
+		return true;
+	});
 }
 
 // called when the transactions in a block have enough additional blocks mined on top of them to be treated as immutable 
 void Network::confirmTransactions(std::vector<unsigned>& transactionIDS) {
-	// confirm transactions
 	for (unsigned transactionID : transactionIDS) {
-		p.lock();
-		Transaction* t = pool[transactionID];
-		if(t != nullptr && t->confirm()){
-			// add to the list of recently confirmed transactions
-			if (recentConfirmations.size() == TRANSACTIONS_TO_SHOW) recentConfirmations.erase(recentConfirmations.begin());
-			recentConfirmations.push_back(std::make_tuple(t->id, t->creationTime, t->confirmationTime));
-			pool[transactionID] = nullptr;
-			delete t;
-		}
-		p.unlock();
+
+		// the last node to confirm the transaction takes it out of the pool
+		Transaction* t = pool.with(transactionID, [](Transaction*& entry) -> Transaction* {
+			Transaction* confirmed = entry;
+			if (confirmed == nullptr || !confirmed->confirm()) return nullptr;
+			entry = nullptr;
+			return confirmed;
+		});
+		if (t == nullptr) continue;
+
+		// add to the list of recently confirmed transactions
+		r.lock();
+		if (recentConfirmations.size() == TRANSACTIONS_TO_SHOW) recentConfirmations.erase(recentConfirmations.begin());
+		recentConfirmations.push_back(std::make_tuple(t->id, t->creationTime, t->confirmationTime));
+		latencies.push_back(t->confirmationTime - t->creationTime);
+		r.unlock();
+		delete t;
 	}
 		
 }
+
+std::vector<time_t> Network::getLatencies() {
+	r.lock();
+	std::vector<time_t> copy = latencies;
+	r.unlock();
+	return copy;
+}
+
+void Network::recordTransfer(size_t bytes) {
+	bytesSent += bytes;
+}
+
+void Network::stop() {
+	running = false;
+}
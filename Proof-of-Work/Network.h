@@ -2,9 +2,13 @@
 #include <mutex>
 #include <random>
 #include <string>
+#include <atomic>
+#include <tuple>
 
 #include "Transaction.h"
 #include "Block.h"
+#include "InstrumentedMutex.h"
+#include "TransactionPool.h"
 
 #ifndef NETWORK_H
 #define NETWORK_H
@@ -13,10 +17,10 @@ class Network {
 
 private:
 
-	std::mt19937_64 rng;
-	std::vector<Transaction*> pool;
+	TransactionPool<Transaction*> pool;
 
-	std::mutex p; // protects pool
+	InstrumentedMutex r{ "Network::r" }; // protects latencies and recent confirmations
+	std::vector<time_t> latencies;
 
 	std::uniform_int_distribution<unsigned long long int> createDistribution();
 
@@ -25,11 +29,26 @@ public:
 	Network();
 
 	std::vector<std::tuple<unsigned, time_t, time_t>> recentConfirmations;
+	std::atomic<bool> running; // cleared to shut the simulation down
+	std::atomic<unsigned long long> bytesSent; // bytes that messages between nodes would take on a real network
 
 	void generateTransactions();
-	Transaction& getTransaction(int requester);
+	// adds a new transaction to the pool, returning its id
+	unsigned int addTransaction(unsigned int input, unsigned int output);
+	// adds a batch of transactions (input, output, size) to the pool, taking each shard's lock once
+	void addTransactions(const std::vector<std::tuple<unsigned int, unsigned int, unsigned int>>& transfers);
+	// returns nullptr once the simulation is stopped
+	Transaction* getTransaction(int requester);
 	void dropTransaction(int id, int dropper);
+	// copies the transaction if it is still unconfirmed, returns false if it is not in the pool
+	bool findTransaction(unsigned int id, Transaction& found);
 	void confirmTransactions(std::vector<unsigned>& transactionIDS);
+	// time from creation to confirmation of every confirmed transaction
+	std::vector<time_t> getLatencies();
+	// counts the bytes of a message sent between nodes
+	void recordTransfer(size_t bytes);
+	// stops transaction generation and tells nodes to finish
+	void stop();
 };
 
 #endif
@@ -6,6 +6,12 @@
 #include <cmath>
 #include <iostream>
 #include <ctime>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <mutex>
 
 #include "Node.h"
 #include "Block.h"
@@ -13,33 +19,59 @@
 #include "Network.h"
 #include "Semaphore.h"
 #include "SHA256.h"
+#include "Serialization.h"
+#include "Timeline.h"
+#include "PerfCounters.h"
+#include "Placement.h"
 
 extern const int BLOCK_SIZE;
 extern const int BLOCK_TIME;
-extern const int ADJUSTMENT_FREQUENCY;
 extern const int CONFIRMATION_DEPTH;
 extern const int SYNCHRONIZATION_FREQUENCY;
 extern const int SYNCHRONIZATION_THRESHOLD;
+extern const int SYNCHRONIZATION_BATCH;
+extern const bool COMPACT_BLOCKS;
+extern const unsigned VALIDATION_THREADS;
+extern const char* const MINING_THREADS;
+extern const unsigned MINING_CHECK_INTERVAL;
 
-std::mutex Node::s;
-std::mutex Node::b;
+InstrumentedMutex Node::s("Node::s");
+InstrumentedMutex Node::b("Node::b");
 
-Node::Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple<Semaphore, int, int>>>& semaphores, std::map<int, Block>& sharedBlocks):
-	id(id), network(network), semaphores(semaphores), sharedBlocks(sharedBlocks) {
+Node::Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple<Semaphore, int, int>>>& semaphores, std::vector<WorkEpoch>& epochs, std::vector<BlockRequests>& requests, std::map<int, std::vector<unsigned char>>& sharedBlocks):
+	id(id), network(network), semaphores(semaphores), epochs(epochs), requests(requests), sharedBlocks(sharedBlocks), miningThreads(countMiningThreads(id)), activity(id) {
+}
+
+long long Node::steadyTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// reads this node's entry from the comma-separated list of thread counts, the last entry applying to any remaining nodes
+unsigned Node::countMiningThreads(unsigned id) {
+	std::stringstream list(MINING_THREADS);
+	std::string entry;
+	unsigned threads = 1;
+	for (unsigned i = 0; i <= id && std::getline(list, entry, ','); i++) {
+		threads = static_cast<unsigned>(std::stoul(entry));
+	}
+	return std::max(1u, threads);
 }
 
 // get transactions from the network to hash
 void Node::getTransactions(std::vector<Transaction>& transactions){
-	activity = "GETTING TRANSACTIONS  ";
+	activity.set(Activity::GettingTransactions);
 	while(transactions.size() < BLOCK_SIZE){
-		Transaction newTransaction = network.getTransaction(id);
-		transactions.push_back(newTransaction);
+		Transaction* newTransaction = network.getTransaction(id);
+
+		// the simulation has been stopped
+		if (newTransaction == nullptr) return;
+		transactions.push_back(*newTransaction);
 	}
 }
 
 // no longer working on these transactions
 void Node::dropTransactions(std::vector<Transaction>& transactions) {
-	activity = "DROPPING TRANSACTIONS ";
+	activity.set(Activity::DroppingTransactions);
 	for (int i = static_cast<int>(transactions.size() - 1); i >= 0; i--) {
 		network.dropTransaction(transactions[i].id, id);
 	}
@@ -47,10 +79,14 @@ void Node::dropTransactions(std::vector<Transaction>& transactions) {
 
 // add block to chain and confirm transactions now at the required depth
 void Node::addBlock(Block b, int height) {
-	activity = "ADDING BLOCK          ";
+	activity.set(Activity::AddingBlock);
 	
 	if(height == blockchain.size()) blockchain.push_back(b);
-	else blockchain[height] = b;
+	else {
+		blockchain[height] = b;
+		forks++;
+	}
+	publish(height);
 
 	// if the block is past confirmation depth, notify the network that the transactions 
 	// can be treated as confirmed
@@ -60,47 +96,135 @@ void Node::addBlock(Block b, int height) {
 		network.confirmTransactions(b.transactions.ids);
 	} 
 
-	if(height % ADJUSTMENT_FREQUENCY == 0) adjustDifficulty();
+	adjustDifficulty(height);
 	if(height % SYNCHRONIZATION_FREQUENCY == 0) checkPartition(id + 1);
 }
 
+void Node::publish(int height) {
+	published.set(height, blockchain[height]);
+}
+
+size_t Node::height() const {
+	return published.size();
+}
+
 // publish a proof-of-work solution
 // with semaphore, first int gives id of successful miner, second is not used
 void Node::notifyNetwork(Block b) {
-	activity = "PUBLISHING BLOCK      ";
+	activity.set(Activity::PublishingBlock);
 
 	for (int i = static_cast<int>(semaphores.size()) - 1; i >= 0; i--) {
 		if (i == id) continue;
 		std::tuple<Semaphore, int, int> t = std::make_tuple(Semaphore::BlockFound, id, static_cast<int>(blockchain.size()-1));
 
-		// locked and unlocked inside loop to allow temporary divergence of blockchains (called a fork)
-		s.lock();
-		semaphores[i].push_back(t);
-		s.unlock();
+		// sent one at a time to allow temporary divergence of blockchains (called a fork)
+		post(i, t);
 	}
 }
 
-// request block of height from another node
-void Node::requestBlock(int from, int height) {
-	activity = "REQUESTING BLOCK      ";
-	
-	// first int is id of node, second is requested height
+// messages are counted as sent on the network, with the sending node's activity recorded on the timeline
+void Node::post(int to, std::tuple<Semaphore, int, int> message) {
 	s.lock();
-	semaphores[from].push_back(std::make_tuple(Semaphore::RequestBlock, id, height));
+	semaphores[to].push_back(message);
+	epochs[to].posted = steadyTime();
+	epochs[to].value++;
 	s.unlock();
+	network.recordTransfer(MESSAGE_SIZE);
+	Timeline::sent(id, describe(std::get<0>(message)), std::get<2>(message), -1, to);
 }
 
-// first int gives index of data array where block is, second is block height
-void Node::sendBlock(int requester, int height) {
-	activity = "SENDING BLOCK         ";
+// request blocks from another node, answered by its serving thread without interrupting its miners
+void Node::requestBlocks(int from, int height, int count) {
+	activity.set(Activity::RequestingBlock);
 
-	// tell node block is unavailable - only hit after checkPartition is called
-	if (height > blockchain.size()) {
+	{
+		std::lock_guard<std::mutex> lock(requests[from].m);
+		requests[from].queue.push_back(std::make_tuple(id, height, count));
+	}
+	requests[from].arrived.notify_one();
+	network.recordTransfer(MESSAGE_SIZE);
+	Timeline::sent(id, describe(Semaphore::RequestBlock), height, -1, from);
+}
+
+bool Node::awaitBlock(std::tuple<Semaphore, int, int>& reply) {
+	auto isReply = [](const std::tuple<Semaphore, int, int>& message) {
+		return std::get<0>(message) == Semaphore::BlockSent || std::get<0>(message) == Semaphore::BlockUnavailable;
+	};
+	while (network.running) {
 		s.lock();
-		semaphores[requester].push_back(std::make_tuple(Semaphore::BlockUnavailable, -1, -1));
+		auto found = std::find_if(semaphores[id].begin(), semaphores[id].end(), isReply);
+		bool received = (found != semaphores[id].end());
+		if (received) {
+			reply = *found;
+			semaphores[id].erase(found);
+		}
 		s.unlock();
-		return;
+		if (received) return true;
+		std::this_thread::yield();
 	}
+	return false;
+}
+
+void Node::discardBlocks(int count) {
+	std::tuple<Semaphore, int, int> reply;
+	for (; count > 0 && awaitBlock(reply); count--) {
+		if (std::get<0>(reply) != Semaphore::BlockSent) continue;
+		b.lock();
+		sharedBlocks.erase(std::get<1>(reply));
+		b.unlock();
+	}
+}
+
+// runs alongside the node's miners, so how quickly peers catch up does not depend on how often the node stops mining
+void Node::serve() {
+	BlockRequests& pending = requests[id];
+	while (true) {
+		std::unique_lock<std::mutex> lock(pending.m);
+		pending.arrived.wait(lock, [this, &pending] { return !pending.queue.empty() || !network.running; });
+		if (!network.running) return;
+		int requester, height, count;
+		std::tie(requester, height, count) = pending.queue.front();
+		pending.queue.pop_front();
+		lock.unlock();
+		Timeline::received(id, describe(Semaphore::RequestBlock), height, -1, requester);
+
+		// every block of the range comes from the same copy of the chain
+		PublishedChain::Snapshot chain = published.snapshot();
+		for (int i = 0; i < count; i++) {
+			if (!sendBlock(chain, requester, height - i)) break;
+		}
+	}
+}
+
+// first int gives index of data array where block is, second is block height
+bool Node::sendBlock(const PublishedChain::Snapshot& chain, int requester, int height) {
+
+	// tell node block is unavailable - only hit after checkPartition is called
+	if (height < 0 || height >= static_cast<int>(chain.size())) {
+		post(requester, std::make_tuple(Semaphore::BlockUnavailable, -1, -1));
+		return false;
+	}
+
+	// the block is sent in its binary form
+	// compact blocks only identify the transactions the requester can find in the pool, the rest are sent in full
+	// the contents of the transactions sent in full are counted along with the encoding
+	std::vector<unsigned char> bytes;
+	const Block& block = chain[height];
+	size_t payload = 0;
+	if (COMPACT_BLOCKS) {
+		std::vector<Transaction> prefilled;
+		Transaction found(0, 0, 0);
+		for (const Transaction& t : block.body) {
+			if (!network.findTransaction(t.id, found) || found.input != t.input || found.output != t.output) prefilled.push_back(t);
+		}
+		block.serializeCompact(bytes, prefilled);
+		payload = payloadSize(prefilled);
+	}
+	else {
+		block.serialize(bytes);
+		payload = payloadSize(block.body);
+	}
+	network.recordTransfer(bytes.size() + payload);
 
 	int i = 0;
 	b.lock();
@@ -108,60 +232,107 @@ void Node::sendBlock(int requester, int height) {
 		i++;
 	}
 
-	sharedBlocks.insert(std::pair<int, Block>(i, blockchain[height]));
+	sharedBlocks.insert(std::make_pair(i, std::move(bytes)));
 	b.unlock();
 
 	// tell requester where to find block
 	// if index is negative this indicates that transactions have not been sent since the requesting node has already confirmed and flushed them 
-	s.lock();
-	semaphores[requester].push_back(std::make_tuple(Semaphore::BlockSent, i, height));
-	s.unlock();
+	post(requester, std::make_tuple(Semaphore::BlockSent, i, height));
+	return true;
 }
 
-// called when another miner sends a new block of the next block height
-void Node::receiveBlock(int index, int height) {
-	activity = "VALIDATING BLOCK      ";
+// checks a received block on its own: its proof-of-work and that its transactions are the ones its header commits to
+// returns nullptr if it is invalid, it is linked to the chain separately
+// safe to call from several threads at once
+std::unique_ptr<Block> Node::validateBlock(int index) {
 
-	// retrieve block
-	Block receivedBlock = sharedBlocks[index];
-	
-	// validate block hash
-	std::string hash;
+	// retrieve block, which is read in place until it is known to be valid
 	b.lock();
-	hash = sha256(blockchain[height - 1].hash + receivedBlock.transactions.getMerkleRoot() + std::to_string(receivedBlock.nonce)); 
+	const std::vector<unsigned char>& bytes = sharedBlocks[index];
 	b.unlock();
-	
-	if (!Block::isValid(hash, receivedBlock.difficulty)) return;
+	BlockView receivedBlock(bytes);
+	if (!receivedBlock.isValid() || !receivedBlock.hasTransactions()) return nullptr;
+
+	// validate block hash
+	std::string hash = sha256(receivedBlock.previousHash() + receivedBlock.merkleRoot() + std::to_string(receivedBlock.nonce()));
+	if (hash != receivedBlock.hash() || !Block::isValid(hash, receivedBlock.difficulty())) return nullptr;
+
+	std::vector<Transaction> transactions;
+	if (!reconstructBlock(receivedBlock, transactions)) return nullptr;
+	std::unique_ptr<Block> block(new Block(receivedBlock.toBlock(transactions)));
+	if (block->transactions.getMerkleRoot() != receivedBlock.merkleRoot()) return nullptr;
+	return block;
+}
+
+// called with blocks sent by another miner, the first of which follows the block at height - 1
+// the blocks are validated in parallel, then added in order for as long as each follows the last
+void Node::receiveBlocks(const std::vector<int>& indices, int height) {
+	activity.set(Activity::ValidatingBlocks);
+
+	std::vector<std::unique_ptr<Block>> blocks(indices.size());
+	unsigned workers = std::max(1u, std::min(VALIDATION_THREADS, static_cast<unsigned>(indices.size())));
+	size_t chunk = (indices.size() + workers - 1) / workers;
+
+	// each worker validates a contiguous range, the last range is validated on this thread
+	std::vector<std::future<void>> ranges;
+	for (size_t first = 0; first < indices.size(); first += chunk) {
+		size_t last = std::min(first + chunk, indices.size());
+		auto validate = [this, &indices, &blocks, first, last] {
+			for (size_t i = first; i < last; i++) blocks[i] = validateBlock(indices[i]);
+		};
+		if (last == indices.size()) validate();
+		else ranges.push_back(std::async(std::launch::async, validate));
+	}
+	for (std::future<void>& range : ranges) range.get();
 
 	// add block to end of chain if it is still the right height (another block may have been received in the meantime)
-	addBlock(receivedBlock, height);
+	for (size_t i = 0; i < blocks.size(); i++) {
+		int blockHeight = height + static_cast<int>(i);
+		if (blocks[i] == nullptr || blockHeight > static_cast<int>(blockchain.size()) || blocks[i]->previousHash != blockchain[blockHeight - 1].hash) break;
+		addBlock(*blocks[i], blockHeight);
+	}
 
 	b.lock();
-	sharedBlocks.erase(index);
+	for (int index : indices) sharedBlocks.erase(index);
 	b.unlock();
 }
 
-// nodes with the same blockchain independently calculate the same network difficulty
-void Node::adjustDifficulty() {
-	activity = "CALCULATING DIFFICULTY";
-
-	size_t blockHeight = blockchain.size();
-	
-	double averageTime = 0;
-	for (int i = ADJUSTMENT_FREQUENCY - 1; i > 0; i--) {
-		averageTime += blockchain.at(blockHeight - i).timestamp - blockchain.at(blockHeight - i - 1).timestamp;
+// the sender includes any transactions that have left the pool, so a compact block is normally completed without another request
+// one confirmed in the meantime cannot be recovered, and the block is then treated as invalid
+bool Node::reconstructBlock(const BlockView& block, std::vector<Transaction>& transactions) {
+	std::vector<Transaction> included = block.decodeTransactions();
+	if (!block.isCompact()) {
+		transactions = included;
+		return true;
 	}
-	averageTime /= (ADJUSTMENT_FREQUENCY-1)*1000;
-	if (averageTime < BLOCK_TIME) {
-		difficulty = blockchain.back().difficulty + 1;
-	} else {
-		difficulty = blockchain.back().difficulty - 1;
+
+	unsigned count = block.transactionCount();
+	transactions.reserve(count);
+	for (unsigned i = 0; i < count; i++) {
+		unsigned transactionID = block.transactionId(i);
+		auto prefilled = std::find_if(included.begin(), included.end(), [transactionID](const Transaction& t) { return t.id == transactionID; });
+		if (prefilled != included.end()) {
+			transactions.push_back(*prefilled);
+			continue;
+		}
+
+		Transaction found(0, 0, 0);
+		if (!network.findTransaction(transactionID, found)) return false;
+		transactions.push_back(found);
 	}
+	return true;
+}
+
+// nodes with the same blockchain independently calculate the same network difficulty
+void Node::adjustDifficulty(int height) {
+	activity.set(Activity::CalculatingDifficulty);
+	retarget.update(blockchain, height);
+	difficulty = retarget.next();
 }
 
 // node calculates the total difficulty of the blockchain
 void Node::checkPartition(unsigned neighbour) {
-	activity = "CHECKING PARTITION    ";
+	activity.set(Activity::CheckingPartition);
 
 	// condition met if all neighbours have been contacted
 	if (neighbour == id) return;
@@ -185,148 +356,249 @@ void Node::checkPartition(unsigned neighbour) {
 }
 
 // request blocks until valid longer tail found
+// blocks are requested in batches, each sent from the highest down, until one follows a block of this node's chain
 void Node::synchronize(int node, int height) {
-	activity = "SYNCHRONIZING         ";
+	activity.set(Activity::Synchronizing);
 
 	// don't want/need to know about blocks at lower depth
-	if (height < blockchain.size()) return;
+	if (height < static_cast<int>(blockchain.size())) return;
 
 	std::vector<int> blockIndices;
-	int initialHeight = height;
+	int requested = 0; // replies still to come for the current batch
 	while(true){
-		requestBlock(node, height);
-
-		// track index of sent block message (may receive BlockFound messages to be processed after synchronization)
-		int semaphoreIndex;
-		while(true){
-			for (semaphoreIndex = 0; semaphoreIndex < semaphores[id].size(); semaphoreIndex++) {
-				switch (std::get<0>(semaphores[id][semaphoreIndex])) {
-				case Semaphore::RequestBlock: {
-					// get necessary data
-					int requester = std::get<1>(semaphores[id][semaphoreIndex]);
-					int height = std::get<2>(semaphores[id][semaphoreIndex]);
-
-					// delete message
-					s.lock();
-					semaphores[id].erase(semaphores[id].begin() + semaphoreIndex);
-					s.unlock();
-
-					sendBlock(requester, height);
-					break;
-				}
-				// requested block has been received
-				case Semaphore::BlockSent:
-					goto exit;
-				// received if node sending is also partitioned when node guesses it is partitioned
-				case Semaphore::BlockUnavailable:
-					s.lock();
-					semaphores[id].erase(semaphores[id].begin() + semaphoreIndex);
-					s.unlock();
-					checkPartition(node + 1);
-					return;
-				default:
-					break;
-				}
-			}
+		if (requested == 0) {
+			requested = std::min(SYNCHRONIZATION_BATCH, height);
+			requestBlocks(node, height, requested);
 		}
-		exit:;
 
-		// find where in the shared data array the block was shared
-		int index = std::get<1>(semaphores[id][semaphoreIndex]);
+		// may receive BlockFound messages in the meantime, to be processed after synchronization
+		std::tuple<Semaphore, int, int> reply;
+		if (!awaitBlock(reply)) return;
+		requested--;
+
+		// received if node sending is also partitioned when node guesses it is partitioned
+		// nothing more is sent for the batch
+		if (std::get<0>(reply) == Semaphore::BlockUnavailable) {
+			Timeline::received(id, describe(Semaphore::BlockUnavailable), -1, -1, node);
+			b.lock();
+			for (int index : blockIndices) sharedBlocks.erase(index);
+			b.unlock();
+			checkPartition(node + 1);
+			return;
+		}
 
-		// delete message
-		s.lock();
-		semaphores[id].erase(semaphores[id].begin() + semaphoreIndex);
-		s.unlock();
+		// find where in the shared data array the block was shared
+		int index = std::get<1>(reply);
+		Timeline::received(id, describe(Semaphore::BlockSent), height, -1, node);
 
 		blockIndices.emplace(blockIndices.begin(), index);
-		Block b = sharedBlocks[index];
+		b.lock();
+		BlockView received(sharedBlocks[index]);
+		b.unlock();
 
 		// if its hash matches with an existing block in the chain we can copy over the blocks received
-		if(height <= blockchain.size() && blockchain[height - 1].hash == b.previousHash) break;
+		if(height <= static_cast<int>(blockchain.size()) && received.isValid() && blockchain[height - 1].hash == received.previousHash()) break;
 
 		height -= 1;
 
 		// if network is partitioned badly enough to be totally unsynchronized then wait to sync with another node
-		if(height < 0) return;
+		if(height < 1) {
+			discardBlocks(requested);
+			b.lock();
+			for (int index : blockIndices) sharedBlocks.erase(index);
+			b.unlock();
+			return;
+		}
 	}
 
+	// the rest of the batch is not needed
+	discardBlocks(requested);
+
 	// copy blockchain over
-	for (int i = 0; i < blockIndices.size(); i++) {
-		receiveBlock(blockIndices[i], i + height);
+	receiveBlocks(blockIndices, height);
+}
+
+// generates hashes, increasing the candidate block's nonce value ("number only used once"), on each of the node's mining threads
+// thread i tries nonces i + 1, i + 1 + n, i + 1 + 2n... so that together they cover the nonce space without repetition
+// returns true with the solution in candidate, or false if a message arrived or the simulation stopped first
+bool Node::solve(Block& candidate) {
+	attempts.assign(miningThreads, candidate);
+	winner = -1;
+
+	// messages queued from here on move the epoch on, earlier ones are already in the queue
+	unsigned epoch = epochs[id].value;
+	s.lock();
+	bool waiting = !semaphores[id].empty();
+	s.unlock();
+	if (waiting) return false;
+
+	// the other mining threads are already running and only wait for the candidate
+	{
+		std::lock_guard<std::mutex> lock(rounds.m);
+		rounds.number++;
+		rounds.epoch = epoch;
+		rounds.finished = 0;
+	}
+	rounds.started.notify_all();
+
+	// the first share is searched on the node's own thread
+	search(0, epoch);
+	{
+		std::unique_lock<std::mutex> lock(rounds.m);
+		rounds.ended.wait(lock, [this] { return rounds.finished == miningThreads - 1; });
+	}
+
+	if (winner < 0) return false;
+	candidate = attempts[winner];
+	return true;
+}
+
+// every thread stops as soon as one of them succeeds, but only checks for messages every MINING_CHECK_INTERVAL hashes
+void Node::search(unsigned thread, unsigned epoch) {
+	Block& attempt = attempts[thread];
+	attempt.nonce += thread + 1 - miningThreads; // wraps around, mine() adds the stride before hashing
+	unsigned long long total = 0;
+	long long checked = steadyTime();
+	while (winner < 0) {
+		unsigned n = 0;
+		while (n < MINING_CHECK_INTERVAL && winner < 0) {
+			n++;
+			if (attempt.mine(miningThreads)) {
+				int none = -1;
+				winner.compare_exchange_strong(none, static_cast<int>(thread));
+				break;
+			}
+		}
+		total += n;
+		if (winner >= 0 || !network.running) break;
+		if (epochs[id].value == epoch) {
+			checked = steadyTime();
+			continue;
+		}
+
+		// the hashes since the message arrived were wasted, assuming they were evenly spread since the last check
+		long long now = steadyTime();
+		long long arrived = std::max(epochs[id].posted.load(), checked);
+		staleHashes += (now > checked ? n * (now - arrived) / (now - checked) : n);
+		reactionTime += now - epochs[id].posted;
+		reactions++;
+		break;
+	}
+	hashes += total;
+}
+
+void Node::work(unsigned thread) {
+	unsigned round = 0;
+	while (true) {
+		std::unique_lock<std::mutex> lock(rounds.m);
+		rounds.started.wait(lock, [this, round] { return rounds.number != round || rounds.closed; });
+		if (rounds.number == round) return;
+		round = rounds.number;
+		unsigned epoch = rounds.epoch;
+		lock.unlock();
+
+		search(thread, epoch);
+
+		lock.lock();
+		rounds.finished++;
+		lock.unlock();
+		rounds.ended.notify_one();
 	}
 }
 
 // node spends vast majority of compute time here 
 void Node::mine() {
-	activity = "MINING                ";
+	activity.set(Activity::Mining);
 
 	if (blockchain.size() == 0) {
 
 		// start blockchain
 		Block genesisBlock;
 		blockchain.push_back(genesisBlock);
+		publish(0);
+		adjustDifficulty(0);
 		std::vector<Transaction> dummyTransactions;
 
 	} else {
-		while (true) {
+		while (network.running) {
 			
 			// get transactions to include in the new block - nodes are not selective here, but could be an application-specific extension
 			std::vector<Transaction> transactions;
 			getTransactions(transactions);
-			activity = "MINING                ";
+			if (!network.running) return;
+			activity.set(Activity::Mining);
 
 			Block candidateBlock(blockchain.back().hash, transactions, difficulty);
 
-			// generate hashes, iteratively increasing the candidate block's nonce value ("number only used once")
-			while(semaphores[id].size() == 0) {
-				if(candidateBlock.mine()) {
-					
-					// if a valid hash is found notify the network
-					addBlock(candidateBlock, static_cast<int>(blockchain.size()));
-					notifyNetwork(candidateBlock);
-					goto cnt;
-				}
+			// if a valid hash is found notify the network
+			if (solve(candidateBlock)) {
+				addBlock(candidateBlock, static_cast<int>(blockchain.size()));
+				notifyNetwork(candidateBlock);
+				continue;
 			}
 			dropTransactions(transactions);
 			break;
-			cnt:;
 		}
+		if (!network.running) return;
+
+		// take the message from the front of the queue, which other nodes may be adding to
+		s.lock();
+		if (semaphores[id].empty()) {
+			s.unlock();
+			return;
+		}
+		std::tuple<Semaphore, int, int> message = semaphores[id].front();
+		semaphores[id].erase(semaphores[id].begin());
+		s.unlock();
+
 		// switch on semaphore
-		switch (std::get<0>(semaphores[id][0])) {
+		switch (std::get<0>(message)) {
 		case Semaphore::BlockFound: {
 			// get necessary data 
-			int node = std::get<1>(semaphores[id][0]);
-			int height = std::get<2>(semaphores[id][0]);
-
-			// delete message
-			s.lock();
-			semaphores[id].erase(semaphores[id].begin());
-			s.unlock();
+			int node = std::get<1>(message);
+			int height = std::get<2>(message);
+			Timeline::received(id, describe(Semaphore::BlockFound), height, -1, node);
 
 			synchronize(node, height);
 			break;
 		}
-		case Semaphore::RequestBlock: {
-			// get necessary data
-			int requester = std::get<1>(semaphores[id][0]);
-			int height = std::get<2>(semaphores[id][0]);
-
-			// delete message
-			s.lock();
-			semaphores[id].erase(semaphores[id].begin());
-			s.unlock();
-
-			sendBlock(requester, height);
+		// a reply that arrived after synchronizing finished, its block is no longer needed
+		case Semaphore::BlockSent:
+			b.lock();
+			sharedBlocks.erase(std::get<1>(message));
+			b.unlock();
+			break;
+		// requests go to the serving thread instead
+		default:
 			break;
-		}
 		}
 	}
 }
 
 void Node::run() {
-	while(true){
-		// mine blocks forever
+	Placement::pin("node", id);
+	PerfCounters::attach("node", id);
+
+	// started once the node is pinned and counting, so that the serving and mining threads run on the same processors and are counted with it
+	std::thread server(&Node::serve, this);
+	std::vector<std::thread> miners;
+	for (unsigned thread = 1; thread < miningThreads; thread++) miners.push_back(std::thread(&Node::work, this, thread));
+	while(network.running){
+		// mine blocks until the simulation is stopped
 		mine();
 	}
+
+	{
+		std::lock_guard<std::mutex> lock(rounds.m);
+		rounds.closed = true;
+	}
+	rounds.started.notify_all();
+	for (std::thread& miner : miners) miner.join();
+
+	// the lock is taken so the serving thread cannot miss the notification between checking and sleeping
+	{
+		std::lock_guard<std::mutex> lock(requests[id].m);
+		requests[id].arrived.notify_all();
+	}
+	server.join();
 }
@@ -1,50 +1,129 @@
 #include <vector>
 #include <mutex>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <condition_variable>
 
 #include "Block.h"
 #include "Transaction.h"
 #include "Network.h"
 #include "Semaphore.h"
+#include "Activity.h"
+#include "InstrumentedMutex.h"
+#include "Serialization.h"
+#include "DifficultyEngine.h"
+#include "PublishedChain.h"
 
 #ifndef NODE_H
 #define NODE_H
 
 extern const int INITIAL_DIFFICULTY;
 
+// moved on whenever a message is queued for a node, so that its miners can notice new work without reading the queue
+// padded to a cache line so that nodes polling their own epoch do not disturb each other
+struct WorkEpoch {
+	std::atomic<unsigned> value;
+	std::atomic<long long> posted; // steady clock time of the latest message in nanoseconds
+	char padding[64 - sizeof(std::atomic<unsigned>) - sizeof(std::atomic<long long>)];
+};
+
+// requests for blocks from a node's chain, answered by its serving thread while the node mines
+struct BlockRequests {
+	std::mutex m;
+	std::condition_variable arrived;
+	std::deque<std::tuple<int, int, int>> queue; // requester, highest height wanted and number of blocks below it
+};
+
+// hands each candidate block to a node's mining threads, which are started with the node and kept until it finishes
+struct MiningRounds {
+	std::mutex m;
+	std::condition_variable started; // a new candidate is ready, or the threads should finish
+	std::condition_variable ended; // a thread has searched its share of the candidate
+	unsigned number = 0; // rounds started so far
+	unsigned epoch = 0; // work epoch the candidate was created in
+	unsigned finished = 0; // threads done with the current round
+	bool closed = false; // no more rounds will be started
+};
+
 class Node {
 
 private:
 
 	Network& network;
 	std::vector<std::vector<std::tuple<Semaphore, int, int>>>& semaphores;
-	std::map<int, Block>& sharedBlocks;
-	int difficulty = INITIAL_DIFFICULTY; // the number of leading zeros required on the hash of a block to be able to add it to the chain (initially)
+	std::vector<WorkEpoch>& epochs;
+	std::vector<BlockRequests>& requests;
+	PublishedChain published; // the blockchain as read by the serving thread
+	std::map<int, std::vector<unsigned char>>& sharedBlocks; // blocks in transit, in their binary form
+	int difficulty = Block::fromLeadingZeros(INITIAL_DIFFICULTY); // required of the next block mined by this node, see Block.h
+	DifficultyEngine retarget; // follows the blockchain to choose the difficulty
+	MiningRounds rounds;
+	std::vector<Block> attempts; // the candidate as searched by each mining thread
+	std::atomic<int> winner{-1}; // the mining thread that solved the candidate, if any
 	
-	static std::mutex s; // to protect the semaphore data array
-	static std::mutex b; // to protect shared block array
+	static InstrumentedMutex s; // to protect the semaphore data array
+	static InstrumentedMutex b; // to protect shared block array
 
 	void getTransactions(std::vector<Transaction>& transactions);
 	void dropTransactions(std::vector<Transaction>& transactions);
 	void addBlock(Block b, int height);
+	// shares the block at the height with the serving thread
+	void publish(int height);
+	static long long steadyTime();
+	// queues a message for another node and moves its epoch on, so that its miners stop working on a candidate block that may now be stale
+	void post(int to, std::tuple<Semaphore, int, int> message);
 	void notifyNetwork(Block b);
-	void requestBlock(int from, int height);
-	void sendBlock(int requester, int height);
-	void receiveBlock(int index, int height);
+	// asks for count blocks, sent from height downwards
+	void requestBlocks(int from, int height, int count);
+	// waits for the next reply to a block request, returns false if the simulation stopped first
+	bool awaitBlock(std::tuple<Semaphore, int, int>& reply);
+	// frees the blocks of replies that are no longer needed
+	void discardBlocks(int count);
+	// answers block requests from the published chain until the simulation stops
+	void serve();
+	// returns false if the chain does not reach the height
+	bool sendBlock(const PublishedChain::Snapshot& chain, int requester, int height);
+	std::unique_ptr<Block> validateBlock(int index);
+	void receiveBlocks(const std::vector<int>& indices, int height);
+	// collects the transactions of a received block, returns false if any cannot be found
+	bool reconstructBlock(const BlockView& block, std::vector<Transaction>& transactions);
 	void checkPartition(unsigned neighbour);
-	void adjustDifficulty();
+	bool solve(Block& candidate);
+	// searches the mining thread's share of the nonces until the candidate is solved or becomes stale
+	void search(unsigned thread, unsigned epoch);
+	// loop of each mining thread other than the node's own, searching every candidate handed over by solve()
+	void work(unsigned thread);
+	void adjustDifficulty(int height);
 	void synchronize(int node, int height);
 	void mine();
 
+	// times post() in Benchmarks/Microbenchmarks.cpp
+	friend class MessageBenchmark;
+
 public:
 
 	const unsigned int id;
+	const unsigned miningThreads; // share of the network's hash power
 	std::vector<Block> blockchain;
-	std::string activity; // information on the node's operation for display
+	ActivityState activity; // information on the node's operation for display
+	unsigned forks = 0; // number of blocks replaced by those of a longer chain
+	std::atomic<unsigned long long> hashes{0};
+	std::atomic<unsigned long long> staleHashes{0}; // estimated hashes done after a message made the candidate block stale
+	std::atomic<long long> reactionTime{0}; // total nanoseconds between messages arriving and mining threads noticing them
+	std::atomic<unsigned> reactions{0};
+
+	// the number of threads the node with this id mines with
+	static unsigned countMiningThreads(unsigned id);
 
-	Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple<Semaphore, int, int>>>& semaphores, std::map<int, Block>& sharedBlocks);
+	Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple<Semaphore, int, int>>>& semaphores, std::vector<WorkEpoch>& epochs, std::vector<BlockRequests>& requests, std::map<int, std::vector<unsigned char>>& sharedBlocks);
 
 	void run();
+
+	// blocks in the node's chain, safe to read from other threads while the node runs
+	size_t height() const;
+
 };
 
 #endif
@@ -0,0 +1,55 @@
+#include <string>
+#include <vector>
+#include <mutex>
+#include <ostream>
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// counts of hardware and scheduler events
+struct PerfSample {
+	unsigned long long cycles = 0;
+	unsigned long long instructions = 0;
+	unsigned long long cacheMisses = 0;
+	unsigned long long branchMisses = 0;
+	unsigned long long contextSwitches = 0;
+
+	PerfSample& operator+=(const PerfSample& other);
+	// as a JSON object
+	std::string toString() const;
+};
+
+// when PERF_COUNTERS is set, threads attach hardware performance counters (perf_event_open on Linux) to themselves
+// threads the attached thread starts afterwards are counted with it, e.g. a node's mining and validation threads
+// counters that cannot be opened (other systems, no access to the performance monitoring unit) read as zero
+class PerfCounters {
+
+private:
+
+	static const int EVENTS = 5;
+
+	struct Counters {
+		std::string role;
+		int index;
+		int fds[EVENTS];
+	};
+
+	static std::vector<Counters> attached;
+	static std::mutex m; // protects the list of attached counters
+
+public:
+
+	static bool enabled();
+	// called by a thread to count its own events, under a role (e.g. "node") and an index within it
+	static void attach(const char* role, int index);
+	// the counts so far of one attached thread, or of every thread of a role when index is negative
+	static PerfSample read(const char* role, int index = -1);
+	// the counts of every attached thread, as a JSON object keyed by role
+	static std::string summary();
+
+	// on POSIX systems SIGUSR2 requests a summary, which is written the next time poll is called
+	static void listen();
+	static void poll(std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include <string>
+#include <vector>
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+// a physical core and the logical processors (SMT siblings) it runs
+struct Core {
+	int numaNode;
+	int package;
+	int id;
+	std::vector<int> processors;
+};
+
+// pins threads to processors according to the PLACEMENT policy, so that measurements are not disturbed by threads migrating:
+// "none" leaves placement to the operating system,
+// "compact" fills the cores of one NUMA node before moving to the next, keeping nodes that exchange blocks close,
+// "spread" deals cores out to the NUMA nodes in turn, sharing memory bandwidth between them
+// nodes are given whole physical cores (one per mining thread), using SMT siblings only once every core is in use
+// the generator and display are kept on cores of their own, away from the nodes and their siblings, while there are enough cores
+class Placement {
+
+private:
+
+	static std::vector<Core> cores; // in the order they are handed out
+	static std::vector<std::vector<int>> nodes; // the processors of each node
+	static std::vector<int> generator;
+	static std::vector<int> monitor;
+
+	static std::vector<Core> detect();
+	static void apply(const std::vector<int>& processors);
+
+public:
+
+	static bool enabled();
+	// assigns processors to nodes given the number of cores each would keep busy, before any thread is started
+	static void configure(const std::vector<unsigned>& weights);
+	// called by a thread to move itself onto its processors
+	static void pin(const char* role, int index);
+	// the policy and where each thread is placed
+	static std::string describe();
+};
+
+#endif
@@ -0,0 +1,54 @@
+// PublishedChain class shares a node's blockchain with other threads.
+// Versions are published with std::atomic_store, which orders the writes to a new slot before any reader can see the larger size.
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+
+#include "PublishedChain.h"
+#include "Block.h"
+
+PublishedChain::Snapshot::Snapshot(std::shared_ptr<const Version> version) :version(version) {}
+
+size_t PublishedChain::Snapshot::size() const {
+	return version->size;
+}
+
+const Block& PublishedChain::Snapshot::operator[](size_t height) const {
+	return *(*(*version->segments)[height / SEGMENT_SIZE])[height % SEGMENT_SIZE];
+}
+
+PublishedChain::PublishedChain() :latest(std::make_shared<const Version>(Version{ std::make_shared<const std::vector<std::shared_ptr<Segment>>>(), 0 })) {}
+
+void PublishedChain::set(size_t height, const Block& block) {
+	std::shared_ptr<const Version> current = std::atomic_load(&latest);
+	std::shared_ptr<const std::vector<std::shared_ptr<Segment>>> segments = current->segments;
+	size_t index = height / SEGMENT_SIZE;
+	std::shared_ptr<const Block> published = std::make_shared<const Block>(block);
+
+	// a replaced block's segment may be read through earlier versions, so it is copied
+	if (height < current->size) {
+		std::shared_ptr<std::vector<std::shared_ptr<Segment>>> copy = std::make_shared<std::vector<std::shared_ptr<Segment>>>(*segments);
+		(*copy)[index] = std::make_shared<Segment>(*(*copy)[index]);
+		(*(*copy)[index])[height % SEGMENT_SIZE] = published;
+		std::atomic_store(&latest, std::make_shared<const Version>(Version{ copy, current->size }));
+		return;
+	}
+
+	// the list of segments is only copied when it grows, once every SEGMENT_SIZE blocks
+	if (index == segments->size()) {
+		std::shared_ptr<std::vector<std::shared_ptr<Segment>>> copy = std::make_shared<std::vector<std::shared_ptr<Segment>>>(*segments);
+		copy->push_back(std::make_shared<Segment>());
+		segments = copy;
+	}
+	(*(*segments)[index])[height % SEGMENT_SIZE] = published;
+	std::atomic_store(&latest, std::make_shared<const Version>(Version{ segments, height + 1 }));
+}
+
+PublishedChain::Snapshot PublishedChain::snapshot() const {
+	return Snapshot(std::atomic_load(&latest));
+}
+
+size_t PublishedChain::size() const {
+	return std::atomic_load(&latest)->size;
+}
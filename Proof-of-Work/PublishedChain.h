@@ -0,0 +1,58 @@
+#include <vector>
+#include <array>
+#include <memory>
+#include <cstddef>
+
+#include "Block.h"
+
+#ifndef PUBLISHEDCHAIN_H
+#define PUBLISHEDCHAIN_H
+
+// a node's blockchain as seen by other threads (its serving thread and the benchmark), which read consistent versions of it
+// without holding up the node
+// blocks are kept in fixed size segments shared between versions: an appended block is written to a slot no earlier version
+// can read, so publishing it copies nothing, while a block replaced after a fork copies only its segment and the list of segments
+class PublishedChain {
+
+private:
+
+	static const size_t SEGMENT_SIZE = 256;
+
+	typedef std::array<std::shared_ptr<const Block>, SEGMENT_SIZE> Segment;
+
+	struct Version {
+		std::shared_ptr<const std::vector<std::shared_ptr<Segment>>> segments;
+		size_t size; // blocks in this version, slots beyond it may be filled by later versions
+	};
+
+	// only accessed through std::atomic_load and std::atomic_store
+	std::shared_ptr<const Version> latest;
+
+public:
+
+	// the chain as it was when the snapshot was taken
+	class Snapshot {
+
+	private:
+
+		std::shared_ptr<const Version> version;
+
+	public:
+
+		Snapshot(std::shared_ptr<const Version> version);
+
+		size_t size() const;
+		const Block& operator[](size_t height) const;
+	};
+
+	PublishedChain();
+	PublishedChain(const PublishedChain&) = delete;
+	PublishedChain& operator=(const PublishedChain&) = delete;
+
+	// appends the block, or replaces the one at its height, only called by the node that owns the chain
+	void set(size_t height, const Block& block);
+	Snapshot snapshot() const;
+	size_t size() const;
+};
+
+#endif
@@ -0,0 +1,12 @@
+// names of the messages nodes pass between them, for the timeline
+#include "Semaphore.h"
+
+const char* describe(Semaphore semaphore) {
+	switch (semaphore) {
+	case Semaphore::BlockFound: return "BlockFound";
+	case Semaphore::RequestBlock: return "RequestBlock";
+	case Semaphore::BlockSent: return "BlockSent";
+	case Semaphore::BlockUnavailable: return "BlockUnavailable";
+	default: return "Unknown";
+	}
+}
@@ -19,4 +19,7 @@ enum class Semaphore {
 
 };
 
+// the name of a type of message
+const char* describe(Semaphore semaphore);
+
 #endif
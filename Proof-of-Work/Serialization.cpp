@@ -0,0 +1,178 @@
+// Serialization of blocks and transactions into the binary form they would take on a real network.
+// Encodings are read through views that decode single fields on demand, so a receiver can check a block's header
+// without copying or decoding its transactions, and the size of every transfer between nodes is known.
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Serialization.h"
+#include "Block.h"
+#include "MerkleTree.h"
+#include "Transaction.h"
+
+static const char digits[] = "0123456789abcdef";
+
+static int digitValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return 0;
+}
+
+void putInteger(std::vector<unsigned char>& bytes, uint64_t value, int count) {
+	for (int i = 0; i < count; i++) {
+		bytes.push_back(static_cast<unsigned char>(value & 0xFF));
+		value >>= 8;
+	}
+}
+
+uint64_t getInteger(const unsigned char* bytes, int count) {
+	uint64_t value = 0;
+	for (int i = count - 1; i >= 0; i--) value = (value << 8) | bytes[i];
+	return value;
+}
+
+void putHash(std::vector<unsigned char>& bytes, const std::string& hash) {
+	for (size_t i = 0; i < 32; i++) {
+		int high = (2 * i < hash.size() ? digitValue(hash[2 * i]) : 0);
+		int low = (2 * i + 1 < hash.size() ? digitValue(hash[2 * i + 1]) : 0);
+		bytes.push_back(static_cast<unsigned char>(high << 4 | low));
+	}
+}
+
+std::string getHash(const unsigned char* bytes) {
+	std::string hash(64, '0');
+	for (size_t i = 0; i < 32; i++) {
+		hash[2 * i] = digits[bytes[i] >> 4];
+		hash[2 * i + 1] = digits[bytes[i] & 0xF];
+	}
+	return hash;
+}
+
+size_t payloadSize(const std::vector<Transaction>& transactions) {
+	size_t total = 0;
+	for (const Transaction& t : transactions) total += t.size;
+	return total;
+}
+
+TransactionView::TransactionView(const unsigned char* data) :data(data) {}
+
+unsigned int TransactionView::id() const {
+	return static_cast<unsigned int>(getInteger(data, 4));
+}
+
+unsigned int TransactionView::input() const {
+	return static_cast<unsigned int>(getInteger(data + 4, 4));
+}
+
+unsigned int TransactionView::output() const {
+	return static_cast<unsigned int>(getInteger(data + 8, 4));
+}
+
+unsigned int TransactionView::size() const {
+	return static_cast<unsigned int>(getInteger(data + 12, 4));
+}
+
+Transaction TransactionView::toTransaction() const {
+	return Transaction(id(), input(), output(), size());
+}
+
+BlockView::BlockView(const unsigned char* data, size_t length) :data(data), length(length) {
+	if (length < FIXED_HEADER_SIZE || data[0] != WIRE_VERSION) return;
+	size_t size = FIXED_HEADER_SIZE + data[FIXED_HEADER_SIZE - 1];
+	if (length < size) return;
+
+	// the transactions must be complete if any are present
+	if (length > size) {
+		if (length < size + 5) return;
+		uint64_t count = getInteger(data + size, 4);
+		size_t end = size + 5;
+		if (data[size + 4] != 0) {
+			end += 4 * count + 4;
+			if (length < end) return;
+			end += TransactionView::SIZE * getInteger(data + end - 4, 4);
+		}
+		else end += TransactionView::SIZE * count;
+		if (length < end) return;
+	}
+	headerSize = size;
+}
+
+BlockView::BlockView(const std::vector<unsigned char>& bytes) :BlockView(bytes.data(), bytes.size()) {}
+
+bool BlockView::isValid() const {
+	return headerSize > 0;
+}
+
+bool BlockView::hasTransactions() const {
+	return length > headerSize;
+}
+
+bool BlockView::isCompact() const {
+	return hasTransactions() && data[headerSize + 4] != 0;
+}
+
+const unsigned char* BlockView::body() const {
+	return data + headerSize + 5;
+}
+
+time_t BlockView::timestamp() const {
+	return static_cast<time_t>(getInteger(data + 1, 8));
+}
+
+unsigned long long BlockView::nonce() const {
+	return getInteger(data + 9, 8);
+}
+
+int BlockView::difficulty() const {
+	return static_cast<int>(static_cast<int32_t>(getInteger(data + 17, 4)));
+}
+
+std::string BlockView::previousHash() const {
+	return getHash(data + 21);
+}
+
+std::string BlockView::hash() const {
+	return getHash(data + 53);
+}
+
+std::string BlockView::merkleRoot() const {
+	return std::string(reinterpret_cast<const char*>(data + FIXED_HEADER_SIZE), data[FIXED_HEADER_SIZE - 1]);
+}
+
+unsigned BlockView::transactionCount() const {
+	return (hasTransactions() ? static_cast<unsigned>(getInteger(data + headerSize, 4)) : 0);
+}
+
+unsigned BlockView::transactionId(unsigned index) const {
+	if (isCompact()) return static_cast<unsigned>(getInteger(body() + 4 * index, 4));
+	return transaction(index).id();
+}
+
+TransactionView BlockView::transaction(unsigned index) const {
+	return TransactionView(body() + TransactionView::SIZE * index);
+}
+
+unsigned BlockView::prefilledCount() const {
+	return (isCompact() ? static_cast<unsigned>(getInteger(body() + 4 * transactionCount(), 4)) : 0);
+}
+
+TransactionView BlockView::prefilled(unsigned index) const {
+	return TransactionView(body() + 4 * transactionCount() + 4 + TransactionView::SIZE * index);
+}
+
+std::vector<Transaction> BlockView::decodeTransactions() const {
+	std::vector<Transaction> transactions;
+	unsigned count = (isCompact() ? prefilledCount() : transactionCount());
+	transactions.reserve(count);
+	for (unsigned i = 0; i < count; i++) transactions.push_back(isCompact() ? prefilled(i).toTransaction() : transaction(i).toTransaction());
+	return transactions;
+}
+
+Block BlockView::toBlock(const std::vector<Transaction>& transactions) const {
+	Block block(previousHash(), transactions, difficulty());
+	block.timestamp = timestamp();
+	block.nonce = nonce();
+	block.hash = hash();
+	return block;
+}
@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "Block.h"
+#include "Transaction.h"
+
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+// blocks are encoded in a compact little-endian binary form, as they would be sent between nodes
+// encoded block: version (1 byte), timestamp (8), nonce (8), difficulty (4), previous hash (32), hash (32),
+//                Merkle root length (1) and Merkle root, then the number of transactions (4) and whether the block is compact (1)
+//                full blocks are followed by the transactions, compact blocks by the transaction ids (4 each)
+//                and then the number of prefilled transactions (4) and those transactions
+// the header is everything before the number of transactions
+// encoded transaction: id, input, output and size (4 bytes each)
+
+// written at the start of every encoded block so that encodings from other versions are rejected
+const unsigned char WIRE_VERSION = 3;
+
+// bytes of a message between nodes: its type and two integers
+const size_t MESSAGE_SIZE = 9;
+
+void putInteger(std::vector<unsigned char>& bytes, uint64_t value, int count);
+uint64_t getInteger(const unsigned char* bytes, int count);
+// hashes are hexadecimal SHA-256 digests, stored as the 32 bytes they represent
+void putHash(std::vector<unsigned char>& bytes, const std::string& hash);
+std::string getHash(const unsigned char* bytes);
+// bytes of the transactions' contents, which the encoding only records the size of (zero unless they were replayed from a trace)
+size_t payloadSize(const std::vector<Transaction>& transactions);
+
+// reads the fields of an encoded transaction in place
+class TransactionView {
+
+private:
+
+	const unsigned char* data;
+
+public:
+
+	static const size_t SIZE = 16;
+
+	TransactionView(const unsigned char* data);
+
+	unsigned int id() const;
+	unsigned int input() const;
+	unsigned int output() const;
+	unsigned int size() const;
+	Transaction toTransaction() const;
+};
+
+// reads the fields of an encoded block (or only its header) in place, without decoding the rest
+class BlockView {
+
+private:
+
+	const unsigned char* data;
+	size_t length;
+	size_t headerSize = 0; // zero if the encoding is not valid
+
+	// position of the first transaction id (compact blocks) or transaction (full blocks)
+	const unsigned char* body() const;
+
+public:
+
+	static const size_t FIXED_HEADER_SIZE = 86;
+
+	BlockView(const unsigned char* data, size_t length);
+	BlockView(const std::vector<unsigned char>& bytes);
+
+	// false if the encoding is truncated or of another version
+	bool isValid() const;
+	// false if only the header was encoded
+	bool hasTransactions() const;
+	// true if the transactions are only identified, to be found in the receiver's pool
+	bool isCompact() const;
+
+	time_t timestamp() const;
+	unsigned long long nonce() const;
+	int difficulty() const;
+	std::string previousHash() const;
+	std::string hash() const;
+	std::string merkleRoot() const;
+	unsigned transactionCount() const;
+	unsigned transactionId(unsigned index) const;
+	// only for full blocks
+	TransactionView transaction(unsigned index) const;
+	// transactions a compact block carries in full, as the sender expects the receiver not to have them
+	unsigned prefilledCount() const;
+	TransactionView prefilled(unsigned index) const;
+
+	// all transactions of a full block, or the prefilled ones of a compact block
+	std::vector<Transaction> decodeTransactions() const;
+	// the block with the given transactions, which should be those identified by the encoding
+	Block toBlock(const std::vector<Transaction>& transactions) const;
+};
+
+#endif
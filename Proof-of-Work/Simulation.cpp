@@ -10,18 +10,43 @@
 #include "Network.h"
 #include "Semaphore.h"
 #include "Monitor.h"
+#include "Parameters.h"
+#include "Benchmark.h"
+#include "Timeline.h"
+#include "InstrumentedMutex.h"
+#include "PerfCounters.h"
+#include "Placement.h"
+#include "LoadGenerator.h"
 
 /* Constants declared as global variables to simplify data collection */
+/* Those read with parameter() can be overridden by environment variables of the same name */
 // the maximum number of transactions that can be included in a new block
-extern const int BLOCK_SIZE = 5;
+extern const int BLOCK_SIZE = parameter("BLOCK_SIZE", 5);
 // targeted average time that a block is generated
-extern const int BLOCK_TIME = 10;
+extern const int BLOCK_TIME = parameter("BLOCK_TIME", 10);
 // number of non-zeros required to begin with
-extern const int INITIAL_DIFFICULTY = 2;
-// number of blocks after which the difficulty is adjusted
-extern const int ADJUSTMENT_FREQUENCY = 20;
-// rate at which transactions are generated, one every TF seconds
-extern const double TRANSACTION_FREQUENCY = 0.1;
+extern const int INITIAL_DIFFICULTY = parameter("INITIAL_DIFFICULTY", 2);
+// how the difficulty follows the block rate: "lwma" or "asert", adjusting it after every block, or "step", see DifficultyEngine.h
+// "asert" holds blocks to a schedule set from the genesis block, so starts best from an INITIAL_DIFFICULTY close to the miners' hash rate
+extern const char* const DIFFICULTY_ALGORITHM = parameter("DIFFICULTY_ALGORITHM", "lwma");
+// number of blocks after which the difficulty is adjusted ("step"), averaged over ("lwma") or its half-life in block times ("asert")
+extern const int ADJUSTMENT_FREQUENCY = parameter("ADJUSTMENT_FREQUENCY", 20);
+// rate at which transactions are generated, one every TF seconds on average
+extern const double TRANSACTION_FREQUENCY = parameter("TRANSACTION_FREQUENCY", 0.1);
+// shape of the transaction arrivals: "constant", "poisson", "bursty" or "trace"
+extern const char* const LOAD_PROFILE = parameter("LOAD_PROFILE", "constant");
+// number of threads generating transactions, each producing an equal share
+extern const unsigned GENERATOR_THREADS = parameter("GENERATOR_THREADS", 1u);
+// most transactions added to the pool under one lock
+extern const unsigned GENERATION_BATCH = parameter("GENERATION_BATCH", 1024u);
+// number of independently locked parts the transaction pool is split into, by transaction id
+extern const unsigned POOL_SHARDS = parameter("POOL_SHARDS", 32u);
+// lengths of the active and idle periods of the bursty profile
+extern const double BURST_SECONDS = parameter("BURST_SECONDS", 1.0);
+extern const double IDLE_SECONDS = parameter("IDLE_SECONDS", 4.0);
+// recorded workload replayed by the "trace" profile (see Benchmarks/MakeTrace.cpp), and how many times faster than recorded
+extern const char* const TRACE_FILE = parameter("TRACE_FILE", "trace.bin");
+extern const double TRACE_SPEED = parameter("TRACE_SPEED", 1.0);
 // since proof-of-work is probabilistic, transactions are never 100% confirmed in the history
 // this heuristic is the number of blocks deep a transaction needs to be before it is treated as confirmed and data is output
 extern const int CONFIRMATION_DEPTH = 5;
@@ -29,32 +54,87 @@ extern const int CONFIRMATION_DEPTH = 5;
 extern const int SYNCHRONIZATION_THRESHOLD = 30;
 // frequency (in blocks) at which a node compares its blockchain to the expected length, detecting a network partition
 extern const int SYNCHRONIZATION_FREQUENCY = 20;
+// number of blocks a synchronizing node asks for at once while looking for where its chain and another's meet
+extern const int SYNCHRONIZATION_BATCH = parameter("SYNCHRONIZATION_BATCH", 8);
 // number of miners (number of cores minus two since display + network simulation both require a thread)
-extern const unsigned AVAILABLE_CONTEXTS = std::thread::hardware_concurrency() - 2;
+extern const unsigned AVAILABLE_CONTEXTS = parameter("AVAILABLE_CONTEXTS", std::thread::hardware_concurrency() - 2);
 // number of recent transactions to display
 extern const int TRANSACTIONS_TO_SHOW = 20;
-// if true, mining is 2x harder per character instead of 16x
+// if true, INITIAL_DIFFICULTY and each step of the "step" algorithm count leading zero bits rather than hexadecimal characters (2x harder each instead of 16x)
 extern const bool BINARY_HASH = false;
+// blocks sent between nodes identify their transactions by id, to be found in the receiver's pool, instead of including them
+extern const bool COMPACT_BLOCKS = parameter("COMPACT_BLOCKS", true);
+// number of threads each node mines with, as a comma-separated list by node id whose last entry applies to the remaining nodes (e.g. "4,2,1")
+extern const char* const MINING_THREADS = parameter("MINING_THREADS", "1");
+// number of hashes each mining thread computes between checks for new messages, bounding how long it takes to react to them
+extern const unsigned MINING_CHECK_INTERVAL = parameter("MINING_CHECK_INTERVAL", 256u);
+// number of threads a node uses to validate the blocks it receives when catching up with the network
+extern const unsigned VALIDATION_THREADS = parameter("VALIDATION_THREADS", std::thread::hardware_concurrency());
+// when set, the locks guarding shared state record how they are contended, reported at the end of bounded runs or on SIGUSR1
+extern const bool LOCK_STATISTICS = parameter("LOCK_STATISTICS", false);
+// how threads are pinned to processors: "none" (left to the operating system), "compact" or "spread" across NUMA nodes, see Placement.h
+extern const char* const PLACEMENT = parameter("PLACEMENT", "none");
+// when set, node, generator and display threads count processor events (cycles, instructions, cache and branch misses, context switches),
+// reported in the summary of bounded runs or on SIGUSR2
+extern const bool PERF_COUNTERS = parameter("PERF_COUNTERS", false);
+// when set, bounded runs write a timeline of every node's activities and messages to this file as Chrome trace events
+extern const char* const TIMELINE_FILE = parameter("TIMELINE_FILE", "");
+// number of the latest events kept for each thread
+extern const unsigned TIMELINE_CAPACITY = parameter("TIMELINE_CAPACITY", 65536u);
+// when either is positive the simulation runs without the display until this many blocks are mined or seconds have passed,
+// then prints a summary of its performance
+extern const int BENCHMARK_BLOCKS = parameter("BENCHMARK_BLOCKS", 0);
+extern const double BENCHMARK_SECONDS = parameter("BENCHMARK_SECONDS", 0.0);
 
 int main() {
 
+	// a trace that cannot be replayed is reported before any thread is started
+	if (!LoadGenerator::available()) return 1;
+
+	InstrumentedMutex::listen();
+	PerfCounters::listen();
+
+	// each node keeps as many cores busy as it has mining threads
+	std::vector<unsigned> weights;
+	for (unsigned i = 0; i < AVAILABLE_CONTEXTS; i++) weights.push_back(Node::countMiningThreads(i));
+	Placement::configure(weights);
+	if (Placement::enabled()) std::cerr << Placement::describe() << std::endl;
+
 	// shared by threads, allows all to retrieve and confirm transactions 
 	Network network;
 
 	// allows nodes to pass messages
 	std::vector<std::vector<std::tuple<Semaphore, int, int>>> semaphores(AVAILABLE_CONTEXTS);
-	// allows nodes to pass data (blocks and transactions)
-	std::map<int, Block> sharedBlocks;
+	std::vector<WorkEpoch> epochs(AVAILABLE_CONTEXTS);
+	std::vector<BlockRequests> requests(AVAILABLE_CONTEXTS);
+	// allows nodes to pass data (encoded blocks)
+	std::map<int, std::vector<unsigned char>> sharedBlocks;
 
 	// start mining threads
 	std::vector<Node*> nodes;
 	std::vector<std::thread> threads;
 	for(unsigned i = 0; i < AVAILABLE_CONTEXTS;){
-		Node* n = new Node(i++, network, semaphores, sharedBlocks);
+		Node* n = new Node(i++, network, semaphores, epochs, requests, sharedBlocks);
 		nodes.push_back(n);
 		threads.push_back(std::thread(&Node::run, n));
 	}
 
+	// bounded runs report a summary instead of displaying the simulation
+	if (BENCHMARK_BLOCKS > 0 || BENCHMARK_SECONDS > 0) {
+		std::thread generator(&Network::generateTransactions, &network);
+		Benchmark benchmark(nodes, network);
+		benchmark.await();
+
+		// let every thread finish cleanly
+		network.stop();
+		generator.join();
+		for (std::thread& t : threads) t.join();
+		std::cout << benchmark.summary() << std::endl;
+		if (LOCK_STATISTICS) InstrumentedMutex::report(std::cerr);
+		if (Timeline::enabled() && !Timeline::write(TIMELINE_FILE)) std::cerr << "Could not write timeline to " << TIMELINE_FILE << std::endl;
+		return 0;
+	}
+
 	// start thread which prints simulation info to the console
 	Monitor* m = new Monitor(semaphores);
 	std::thread display(&Monitor::display, m, nodes, &network);
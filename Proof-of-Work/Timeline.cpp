@@ -0,0 +1,113 @@
+// Timeline class records what nodes do and the messages they pass, so that rounds of consensus, forks and their resolution
+// can be seen over time rather than only as the latest state on the display.
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+
+#include "Timeline.h"
+
+extern const char* const TIMELINE_FILE;
+extern const unsigned TIMELINE_CAPACITY;
+
+std::vector<std::unique_ptr<Timeline::Buffer>> Timeline::buffers;
+std::mutex Timeline::m;
+
+bool Timeline::enabled() {
+	return TIMELINE_FILE[0] != '\0';
+}
+
+// the buffers outlive their threads so that they can be written out after the threads have been joined
+Timeline::Buffer& Timeline::local() {
+	thread_local Buffer* buffer = nullptr;
+	if (buffer == nullptr) {
+		std::unique_ptr<Buffer> created(new Buffer());
+		created->events.resize(std::max(1u, TIMELINE_CAPACITY));
+		buffer = created.get();
+		std::lock_guard<std::mutex> lock(m);
+		buffers.push_back(std::move(created));
+	}
+	return *buffer;
+}
+
+void Timeline::record(const TimelineEvent& event) {
+	Buffer& buffer = local();
+	buffer.events[buffer.next % buffer.events.size()] = event;
+	buffer.next++;
+}
+
+static long long steadyTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Timeline::activity(int node, const char* name) {
+	if (!enabled()) return;
+	record({ steadyTime(), name, 'A', node, -1, -1, -1 });
+}
+
+void Timeline::sent(int node, const char* type, int height, int view, int peer) {
+	if (!enabled()) return;
+	record({ steadyTime(), type, 'S', node, height, view, peer });
+}
+
+void Timeline::received(int node, const char* type, int height, int view, int peer) {
+	if (!enabled()) return;
+	record({ steadyTime(), type, 'R', node, height, view, peer });
+}
+
+bool Timeline::write(const std::string& path) {
+	std::ofstream file(path);
+	if (!file) return false;
+
+	std::lock_guard<std::mutex> lock(m);
+
+	// times are given in microseconds from the first event kept
+	long long start = -1;
+	for (const std::unique_ptr<Buffer>& buffer : buffers) {
+		size_t kept = static_cast<size_t>(std::min<unsigned long long>(buffer->next, buffer->events.size()));
+		for (size_t i = 0; i < kept; i++) {
+			long long time = buffer->events[i].time;
+			if (start < 0 || time < start) start = time;
+		}
+	}
+	auto microseconds = [start](long long time) { return (time - start) / 1000.0; };
+
+	file << "{\"traceEvents\": [";
+	bool first = true;
+	auto separate = [&file, &first] { file << (first ? "\n" : ",\n"); first = false; };
+
+	std::vector<int> named;
+	for (const std::unique_ptr<Buffer>& buffer : buffers) {
+		unsigned long long capacity = buffer->events.size();
+		unsigned long long oldest = (buffer->next > capacity ? buffer->next - capacity : 0);
+		const TimelineEvent* activity = nullptr;
+
+		for (unsigned long long i = oldest; i < buffer->next; i++) {
+			const TimelineEvent& event = buffer->events[i % capacity];
+
+			// each node is shown as a thread
+			if (std::find(named.begin(), named.end(), event.node) == named.end()) {
+				named.push_back(event.node);
+				separate();
+				file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << event.node << ", \"args\": {\"name\": \"node " << event.node << "\"}}";
+			}
+
+			if (event.kind == 'A') {
+				if (activity != nullptr) {
+					separate();
+					file << "{\"name\": \"" << activity->name << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << activity->node
+						<< ", \"ts\": " << microseconds(activity->time) << ", \"dur\": " << (event.time - activity->time) / 1000.0 << "}";
+				}
+				activity = &event;
+				continue;
+			}
+
+			separate();
+			file << "{\"name\": \"" << (event.kind == 'S' ? "send " : "receive ") << event.name << "\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 0, \"tid\": " << event.node
+				<< ", \"ts\": " << microseconds(event.time) << ", \"args\": {\"height\": " << event.height << ", \"view\": " << event.view << ", \"peer\": " << event.peer << "}}";
+		}
+	}
+	file << "\n]}\n";
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,50 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+// something a node did at a point in time
+struct TimelineEvent {
+	long long time; // steady clock time in nanoseconds
+	const char* name; // the activity started or the type of message
+	char kind; // 'A' for an activity, 'S' for a message sent or 'R' for one received
+	int node;
+	int height;
+	int view;
+	int peer; // the node the message was sent to or received from, -1 for all or unknown
+};
+
+// records each node's activities and messages for viewing on a timeline, when TIMELINE_FILE is set
+// events go into ring buffers written only by the thread they belong to, so recording takes no lock once a thread has its buffer
+// keeping the latest TIMELINE_CAPACITY events of each thread
+class Timeline {
+
+private:
+
+	struct Buffer {
+		std::vector<TimelineEvent> events;
+		unsigned long long next = 0; // number of events ever recorded, the oldest are overwritten
+	};
+
+	static std::vector<std::unique_ptr<Buffer>> buffers;
+	static std::mutex m; // protects the list of buffers
+
+	static Buffer& local();
+	static void record(const TimelineEvent& event);
+
+public:
+
+	static bool enabled();
+	static void activity(int node, const char* name);
+	static void sent(int node, const char* type, int height, int view, int peer);
+	static void received(int node, const char* type, int height, int view, int peer);
+
+	// writes the recorded events as Chrome trace events (for chrome://tracing or Perfetto), once the recording threads have stopped
+	// activities become spans lasting until the next activity of the same thread, messages become instants
+	static bool write(const std::string& path);
+};
+
+#endif
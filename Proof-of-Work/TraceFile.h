@@ -0,0 +1,53 @@
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+// a recorded transaction arrival
+struct TraceRecord {
+	uint64_t time; // microseconds since the start of the trace
+	uint32_t id; // id of the transaction in the recorded workload
+	uint32_t size; // bytes
+};
+
+// a recorded workload, mapped into memory rather than read so that replay is not held up by parsing
+// the file is a 16 byte header ("TXTRACE" and a zero byte, a 32 bit version and 4 unused bytes) followed by
+// 16 byte records in order of arrival, each a 64 bit time then 32 bit id and size, all little-endian
+class TraceFile {
+
+private:
+
+	const unsigned char* data = nullptr;
+	size_t length = 0; // bytes mapped
+	size_t records = 0;
+
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#else
+	int file = -1;
+#endif
+
+	// closes the file, leaving the trace empty
+	void unmap();
+
+public:
+
+	static const size_t HEADER_SIZE = 16;
+	static const size_t RECORD_SIZE = 16;
+	static const uint32_t VERSION = 1;
+
+	// the trace is empty if the file cannot be opened or is not a trace
+	TraceFile(const std::string& path);
+	~TraceFile();
+	TraceFile(const TraceFile&) = delete;
+	TraceFile& operator=(const TraceFile&) = delete;
+
+	bool isOpen() const;
+	size_t size() const;
+	TraceRecord operator[](size_t index) const;
+};
+
+#endif
@@ -1,7 +1,5 @@
 #include <string>
 #include <array>
-#include <sstream>
-#include <iomanip>
 #include <chrono>
 #include <iostream>
 
@@ -15,22 +13,25 @@ static std::ofstream out("output_directory/example.csv");
 std::ofstream& Transaction::csv = out;
 
 // create a transaction from sender to recipient
-Transaction::Transaction(unsigned int id, unsigned int input, unsigned int output):id(id), input(input), output(output) {
+Transaction::Transaction(unsigned int id, unsigned int input, unsigned int output, unsigned int size):id(id), input(input), output(output), size(size) {
 	creationTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 	confirmations = 0;
 	collected = false;
 }
 
-// converts an int to a hexadecimal string with leading zeros
-std::string Transaction::toHexString(unsigned int i) {
-	std::stringstream stream;
-	stream << std::setfill('0') << std::setw(8) << std::hex << i;
-	return stream.str();
+// fields are written little-endian so that the encoding (and so the hash) is the same on every machine
+void Transaction::serialize(unsigned char* bytes) const {
+	const unsigned int fields[] = { id, input, output, size };
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) bytes[4 * i + j] = static_cast<unsigned char>(fields[i] >> (8 * j));
+	}
 }
 
-// converts the transaction to a hexadecimal string, ready for hashing
-std::string Transaction::toString() {
-	return toHexString(id) + toHexString(input) + toHexString(output);
+// converts the transaction to its binary encoding, ready for hashing
+std::string Transaction::toString() const {
+	std::string bytes(16, '\0');
+	serialize(reinterpret_cast<unsigned char*>(&bytes[0]));
+	return bytes;
 }
 
 bool Transaction::confirm() {
@@ -0,0 +1,84 @@
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "InstrumentedMutex.h"
+
+#ifndef TRANSACTIONPOOL_H
+#define TRANSACTIONPOOL_H
+
+// the pool of unconfirmed transactions, split into shards by transaction id (id modulo the number of shards),
+// each with its own lock, so that nodes working on different transactions seldom wait for each other
+// ids are handed out in order, and a transaction only becomes visible once every transaction with a lower id has been added,
+// so the transactions below size() always form a complete snapshot across the shards
+// T is a (possibly smart) pointer to a transaction, a null entry is a confirmed transaction
+template <typename T>
+class TransactionPool {
+
+private:
+
+	struct Shard {
+		std::string name; // for lock statistics, must outlive the mutex
+		InstrumentedMutex m;
+		std::vector<T> transactions; // the transaction with id i is at i / number of shards
+
+		Shard(const std::string& name) :name(name), m(this->name.c_str()) {}
+	};
+
+	std::vector<std::unique_ptr<Shard>> shards; // allocated separately so that the locks do not share cache lines
+	std::atomic<unsigned> reserved; // ids handed out
+	std::atomic<unsigned> published; // ids below this have been added
+
+public:
+
+	TransactionPool(unsigned count) {
+		for (unsigned i = 0; i < (count > 0 ? count : 1); i++) shards.emplace_back(new Shard("Network::pool[" + std::to_string(i) + "]"));
+		reserved = 0;
+		published = 0;
+	}
+
+	// gives the transactions the next ids and adds them, taking each shard's lock once
+	void add(const std::vector<T>& batch) {
+		unsigned count = static_cast<unsigned>(shards.size());
+		unsigned first = reserved.fetch_add(static_cast<unsigned>(batch.size()));
+		for (unsigned s = 0; s < count; s++) {
+			// the first transaction of the batch belonging to this shard
+			size_t i = (s + count - first % count) % count;
+			if (i >= batch.size()) continue;
+
+			Shard& shard = *shards[s];
+			std::lock_guard<InstrumentedMutex> lock(shard.m);
+			for (; i < batch.size(); i += count) {
+				unsigned id = first + static_cast<unsigned>(i);
+				batch[i]->id = id;
+				if (shard.transactions.size() <= id / count) shard.transactions.resize(id / count + 1);
+				shard.transactions[id / count] = batch[i];
+			}
+		}
+
+		// batches added at the same time are published in order of their ids
+		while (published != first) std::this_thread::yield();
+		published = first + static_cast<unsigned>(batch.size());
+	}
+
+	// the number of transactions ever added, all with lower ids can be read
+	unsigned size() const {
+		return published;
+	}
+
+	// calls f with the entry of a transaction while holding its shard's lock, the entry can be changed or cleared
+	// returns what f returns
+	template <typename F>
+	auto with(unsigned id, F f) -> decltype(f(std::declval<T&>())) {
+		unsigned count = static_cast<unsigned>(shards.size());
+		Shard& shard = *shards[id % count];
+		std::lock_guard<InstrumentedMutex> lock(shard.m);
+		T empty = nullptr;
+		return f(id < published && id / count < shard.transactions.size() ? shard.transactions[id / count] : empty);
+	}
+};
+
+#endif
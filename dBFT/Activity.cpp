@@ -0,0 +1,44 @@
+// ActivityState records what a node is doing for the display, and for how long it has done each thing.
+// Transitions are stored in atomics rather than strings so that reading them from other threads needs no lock and no allocation.
+#include <chrono>
+
+#include "Activity.h"
+#include "Timeline.h"
+
+static long long steadyTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* describe(Activity activity) {
+	switch (activity) {
+	case Activity::InitialisingRound: return "INITIALISING ROUND";
+	case Activity::MonitoringNetwork: return "MONITORING NETWORK";
+	case Activity::PublishingProposal: return "PUBLISHING PROPOSAL";
+	case Activity::ValidatingProposal: return "VALIDATING PROPOSAL";
+	case Activity::BroadcastingMessage: return "BROADCASTING MESSAGE";
+	case Activity::ReceivingResponses: return "RECEIVING RESPONSES";
+	case Activity::PublishingBlock: return "PUBLISHING BLOCK";
+	case Activity::AddingBlock: return "ADDING BLOCK";
+	default: return "NONE";
+	}
+}
+
+ActivityState::ActivityState(int node) :node(node) {
+	current = Activity::None;
+	since = steadyTime();
+	for (std::atomic<long long>& s : spent) s = 0;
+}
+
+void ActivityState::set(Activity activity) {
+	long long now = steadyTime();
+	spent[static_cast<int>(current.load())] += now - since;
+	since = now;
+	current = activity;
+	Timeline::activity(node, describe(activity));
+}
+
+double ActivityState::seconds(Activity activity) const {
+	long long total = spent[static_cast<int>(activity)];
+	if (current == activity) total += steadyTime() - since;
+	return total * 1e-9;
+}
@@ -0,0 +1,50 @@
+#include <atomic>
+
+#ifndef ACTIVITY_H
+#define ACTIVITY_H
+
+// the stages of a bookkeeper's operation
+enum class Activity {
+	None,
+	InitialisingRound,
+	MonitoringNetwork,
+	PublishingProposal,
+	ValidatingProposal,
+	BroadcastingMessage,
+	ReceivingResponses,
+	PublishingBlock,
+	AddingBlock,
+	Count // the number of activities, not an activity itself
+};
+
+// the name of an activity as shown on the display
+const char* describe(Activity activity);
+
+// a node's current activity and how long it has spent on each, written by the node at every transition and read by the display and benchmarks
+// padded on both sides so that it never shares a cache line with a neighbouring node's fields
+class ActivityState {
+
+private:
+
+	char before[64];
+
+public:
+
+	const int node; // the node the state belongs to, for the timeline
+	std::atomic<Activity> current;
+	std::atomic<long long> since; // steady clock time of the latest transition in nanoseconds
+	std::atomic<long long> spent[static_cast<int>(Activity::Count)]; // nanoseconds spent in each activity before the latest transition
+
+	ActivityState(int node);
+
+	// only called by the node the state belongs to
+	void set(Activity activity);
+	// including the time spent in the current activity so far
+	double seconds(Activity activity) const;
+
+private:
+
+	char after[64];
+};
+
+#endif
@@ -0,0 +1,125 @@
+// Benchmark class drives bounded runs of the simulation, used to compare the capacity of dBFT against proof-of-work.
+// A run ends after a number of blocks or seconds, after which the throughput, confirmation latency and block rate are reported.
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include "Benchmark.h"
+#include "Node.h"
+#include "Activity.h"
+#include "InstrumentedMutex.h"
+#include "PerfCounters.h"
+#include "Network.h"
+
+extern const int BLOCK_SIZE;
+extern const int BLOCK_TIME;
+extern const unsigned NUMBER_OF_NODES;
+extern const unsigned UNRESPONSIVE_NODES;
+extern const unsigned MALICIOUS_NODES;
+extern const int BENCHMARK_BLOCKS;
+extern const double BENCHMARK_SECONDS;
+
+Benchmark::Benchmark(std::vector<Node*>& nodes, Network& network) :nodes(nodes), network(network) {
+	start = std::chrono::steady_clock::now();
+	cpuStart = cpuTime();
+}
+
+// on Windows std::clock measures wall time, so the process times are read directly
+double Benchmark::cpuTime() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	auto toSeconds = [](FILETIME t) { return ((static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7; };
+	return toSeconds(kernel) + toSeconds(user);
+#else
+	return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+double Benchmark::percentile(const std::vector<time_t>& sorted, double fraction) {
+	if (sorted.size() == 0) return 0;
+	size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+	return static_cast<double>(sorted[index]);
+}
+
+int Benchmark::height() {
+	int highest = 0;
+	for (Node* n : nodes) {
+		if (n->blockHeight > highest) highest = n->blockHeight;
+	}
+	return highest;
+}
+
+void Benchmark::await() {
+	while (true) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		InstrumentedMutex::poll(std::cerr);
+		PerfCounters::poll(std::cerr);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (BENCHMARK_BLOCKS > 0 && height() >= BENCHMARK_BLOCKS) break;
+		if (BENCHMARK_SECONDS > 0 && elapsed >= BENCHMARK_SECONDS) break;
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	cpuSeconds = cpuTime() - cpuStart;
+}
+
+std::string Benchmark::summary() {
+	Network::r.lock();
+	std::vector<time_t> sorted = network.latencies;
+	Network::r.unlock();
+	std::sort(sorted.begin(), sorted.end());
+
+	// view changes are seen by every node, so are taken from the node furthest ahead
+	unsigned viewChanges = 0;
+	int blocks = 0;
+	for (Node* n : nodes) {
+		if (n->blockHeight > blocks || (n->blockHeight == blocks && n->viewChanges > viewChanges)) {
+			blocks = n->blockHeight;
+			viewChanges = n->viewChanges;
+		}
+	}
+
+	std::stringstream ss;
+	ss << "{\"protocol\": \"dBFT\"";
+	ss << ", \"nodes\": " << NUMBER_OF_NODES;
+	ss << ", \"unresponsive_nodes\": " << UNRESPONSIVE_NODES;
+	ss << ", \"malicious_nodes\": " << MALICIOUS_NODES;
+	ss << ", \"block_size\": " << BLOCK_SIZE;
+	ss << ", \"block_time\": " << BLOCK_TIME;
+	ss << ", \"seconds\": " << seconds;
+	ss << ", \"blocks\": " << blocks;
+	ss << ", \"blocks_per_minute\": " << blocks * 60 / seconds;
+	ss << ", \"confirmed_transactions\": " << sorted.size();
+	ss << ", \"transactions_per_second\": " << sorted.size() / seconds;
+	ss << ", \"latency_ms\": {\"p50\": " << percentile(sorted, 0.5) << ", \"p99\": " << percentile(sorted, 0.99) << ", \"p999\": " << percentile(sorted, 0.999) << "}";
+	ss << ", \"view_changes\": " << viewChanges;
+	ss << ", \"bytes_sent\": " << network.bytesSent.load();
+	// time spent by all nodes in each activity, showing where their time goes
+	ss << ", \"activity_seconds\": {";
+	for (int a = 0; a < static_cast<int>(Activity::Count); a++) {
+		double total = 0;
+		for (Node* n : nodes) total += n->activity.seconds(static_cast<Activity>(a));
+		ss << (a > 0 ? ", " : "") << "\"" << describe(static_cast<Activity>(a)) << "\": " << total;
+	}
+	ss << "}";
+	ss << ", \"cpu_seconds\": " << cpuSeconds;
+	if (PerfCounters::enabled()) {
+		// every node takes part in each view it reaches, whether it ends in a block or a view change
+		unsigned long long rounds = 0;
+		for (Node* n : nodes) rounds += n->blockHeight + n->viewChanges;
+		PerfSample consensus = PerfCounters::read("node");
+		ss << ", \"perf\": " << PerfCounters::summary();
+		ss << ", \"cycles_per_round\": " << (rounds > 0 ? static_cast<double>(consensus.cycles) / rounds : 0);
+	}
+	ss << "}";
+	return ss.str();
+}
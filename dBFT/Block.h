@@ -18,6 +18,8 @@ public:
 
 	Block();
 	Block(std::string previousBlockHash, std::vector<Transaction> transactions);
+	// for a tree already built, e.g. incrementally by the speaker
+	Block(std::string previousBlockHash, const MerkleTree& transactions);
 
 };
 
@@ -0,0 +1,96 @@
+// BroadcastLog class is the message channel between consensus nodes.
+// A broadcast is a single append under one lock, rather than a locked push into the queue of every node.
+// Nodes read from the log at their own pace without locking, and segments are freed once all nodes have read past them.
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <climits>
+
+#include "BroadcastLog.h"
+#include "Semaphore.h"
+
+BroadcastLog::BroadcastLog(unsigned readers) :readers(readers) {
+	head = std::make_shared<Segment>();
+	head->first = 0;
+	tail = head;
+	published.store(0);
+	for (Reader& reader : this->readers) {
+		reader.segment = head;
+		reader.cursor.store(0);
+	}
+}
+
+void BroadcastLog::reclaim() {
+	unsigned long long lowest = ULLONG_MAX;
+	for (Reader& reader : readers) {
+		unsigned long long cursor = reader.cursor.load(std::memory_order_acquire);
+		if (cursor < lowest) lowest = cursor;
+	}
+
+	// readers part way through a dropped segment keep it alive through their own reference
+	while (head != tail && head->first + SEGMENT_SIZE <= lowest) {
+		head = head->next;
+	}
+}
+
+void BroadcastLog::append(const std::tuple<Semaphore, int, int, int>& message) {
+	std::lock_guard<InstrumentedMutex> lock(m);
+	unsigned long long position = published.load(std::memory_order_relaxed);
+
+	// start a new segment when the current one is full
+	if (position == tail->first + SEGMENT_SIZE) {
+		std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+		segment->first = position;
+		tail->next = segment;
+		tail = segment;
+		reclaim();
+	}
+	tail->messages[position - tail->first] = message;
+
+	// the message (and any new segment) is visible to readers once published is incremented
+	published.store(position + 1, std::memory_order_release);
+}
+
+bool BroadcastLog::peek(unsigned reader, std::tuple<Semaphore, int, int, int>& message) {
+	Reader& r = readers[reader];
+	unsigned long long cursor = r.cursor.load(std::memory_order_relaxed);
+	if (cursor >= published.load(std::memory_order_acquire)) return false;
+
+	// move on to the next segment once the current one has been read
+	if (cursor == r.segment->first + SEGMENT_SIZE) r.segment = r.segment->next;
+	message = r.segment->messages[cursor - r.segment->first];
+	return true;
+}
+
+void BroadcastLog::pop(unsigned reader) {
+	Reader& r = readers[reader];
+	r.cursor.store(r.cursor.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+std::vector<std::tuple<Semaphore, int, int, int>> BroadcastLog::unread(unsigned reader, size_t max) {
+	std::vector<std::tuple<Semaphore, int, int, int>> messages;
+
+	// holding the lock stops segments being reclaimed while they are walked
+	std::lock_guard<InstrumentedMutex> lock(m);
+	unsigned long long cursor = readers[reader].cursor.load(std::memory_order_acquire);
+	unsigned long long end = published.load(std::memory_order_acquire);
+
+	std::shared_ptr<Segment> segment = head;
+	while (cursor < end && messages.size() < max) {
+		if (cursor >= segment->first + SEGMENT_SIZE) {
+			segment = segment->next;
+			continue;
+		}
+		messages.push_back(segment->messages[cursor - segment->first]);
+		cursor++;
+	}
+	return messages;
+}
+
+void BroadcastLog::unsubscribe(unsigned reader) {
+	std::lock_guard<InstrumentedMutex> lock(m);
+	readers[reader].cursor.store(ULLONG_MAX, std::memory_order_release);
+	readers[reader].segment = nullptr;
+}
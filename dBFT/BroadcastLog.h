@@ -0,0 +1,59 @@
+#include <vector>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "Semaphore.h"
+#include "InstrumentedMutex.h"
+
+#ifndef BROADCASTLOG_H
+#define BROADCASTLOG_H
+
+// a message channel that every node reads from
+// each message is written once to a shared append-only log and each node keeps its own position (cursor) within it
+class BroadcastLog {
+
+private:
+
+	static const unsigned SEGMENT_SIZE = 256;
+
+	// messages are stored in fixed size segments, linked in the order they were written
+	struct Segment {
+		unsigned long long first; // position in the log of the segment's first message
+		std::array<std::tuple<Semaphore, int, int, int>, SEGMENT_SIZE> messages;
+		std::shared_ptr<Segment> next;
+	};
+
+	struct Reader {
+		std::shared_ptr<Segment> segment; // only used by the reading node
+		std::atomic<unsigned long long> cursor; // position of the next message to read
+	};
+
+	InstrumentedMutex m{ "BroadcastLog::m" }; // serialises writers and the reclaiming of segments
+	std::shared_ptr<Segment> head; // oldest segment that a reader may still need
+	std::shared_ptr<Segment> tail;
+	std::atomic<unsigned long long> published; // number of messages written
+	std::vector<Reader> readers;
+
+	// drops segments that every subscribed reader has passed
+	void reclaim();
+
+public:
+
+	BroadcastLog(unsigned readers);
+
+	// send a message to all nodes
+	void append(const std::tuple<Semaphore, int, int, int>& message);
+	// returns false if the reader has no unread messages, otherwise copies the next one without consuming it
+	bool peek(unsigned reader, std::tuple<Semaphore, int, int, int>& message);
+	// consumes the message last returned by peek
+	void pop(unsigned reader);
+	// copies up to max unread messages of a reader (used by the display)
+	std::vector<std::tuple<Semaphore, int, int, int>> unread(unsigned reader, size_t max);
+	// called when a node stops reading so it no longer holds back reclaiming
+	void unsubscribe(unsigned reader);
+};
+
+#endif
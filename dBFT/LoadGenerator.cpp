@@ -0,0 +1,159 @@
+// LoadGenerator class produces the stream of transactions submitted by users of the network.
+// Arrival times are drawn in advance from the chosen profile and every transaction that is due is added to the pool in one batch,
+// so the rate is not bounded by the granularity of sleeping between transactions.
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <iostream>
+
+#include "LoadGenerator.h"
+#include "Network.h"
+#include "TraceFile.h"
+
+extern const double TRANSACTION_FREQUENCY;
+extern const char* const LOAD_PROFILE;
+extern const unsigned GENERATOR_THREADS;
+extern const unsigned GENERATION_BATCH;
+extern const double BURST_SECONDS;
+extern const double IDLE_SECONDS;
+extern const char* const TRACE_FILE;
+extern const double TRACE_SPEED;
+
+// longest a generator sleeps before checking whether the simulation has been stopped
+static const double maximumSleep = 0.1;
+
+LoadGenerator::LoadGenerator(Network& network) :network(network), profile(parseProfile(LOAD_PROFILE)),
+	threads(std::max(GENERATOR_THREADS, 1u)), rate(1.0 / TRANSACTION_FREQUENCY / std::max(GENERATOR_THREADS, 1u)) {
+	if (profile == LoadProfile::Trace) trace.reset(new TraceFile(TRACE_FILE));
+}
+
+LoadProfile LoadGenerator::parseProfile(const std::string& name) {
+	if (name == "poisson") return LoadProfile::Poisson;
+	if (name == "bursty") return LoadProfile::Bursty;
+	if (name == "trace") return LoadProfile::Trace;
+	return LoadProfile::Constant;
+}
+
+double LoadGenerator::nextArrival(double previous, std::mt19937_64& rng) {
+	switch (profile) {
+	case LoadProfile::Poisson: {
+		std::exponential_distribution<double> gap(rate);
+		return previous + gap(rng);
+	}
+
+	// arrivals are faster during a burst to keep the same average, those falling in an idle period are moved to the next burst
+	// the exponential distribution is memoryless so restarting the burst does not change its shape
+	case LoadProfile::Bursty: {
+		double period = BURST_SECONDS + IDLE_SECONDS;
+		std::exponential_distribution<double> gap(rate * period / BURST_SECONDS);
+		double next = previous + gap(rng);
+		double phase = std::fmod(next, period);
+		if (phase >= BURST_SECONDS) next += period - phase;
+		return next;
+	}
+
+	default:
+		return previous + 1.0 / rate;
+	}
+}
+
+void LoadGenerator::generate(unsigned thread) {
+	std::random_device rd;
+	std::mt19937_64 rng(rd() + thread);
+	std::uniform_int_distribution<unsigned int> dist(1, 100000);
+
+	std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> batch;
+	batch.reserve(GENERATION_BATCH);
+
+	// threads start at different points in the constant profile so their arrivals interleave
+	auto start = std::chrono::steady_clock::now();
+	double next = (profile == LoadProfile::Constant ? thread / (rate * threads) : nextArrival(0, rng));
+
+	while (network.running) {
+		double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// collect every transaction that is due, a full batch is added before collecting the rest
+		while (next <= now && batch.size() < GENERATION_BATCH) {
+			batch.push_back(std::make_tuple(dist(rng), dist(rng), 0u));
+			next = nextArrival(next, rng);
+		}
+		if (batch.size() > 0) {
+			network.addTransactions(batch);
+			if (batch.size() == GENERATION_BATCH) {
+				batch.clear();
+				continue;
+			}
+			batch.clear();
+		}
+
+		double wait = std::min(next - now, maximumSleep);
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(now + wait)));
+	}
+}
+
+// the recorded id is carried as the input of the transaction, and generation stops once the trace has been replayed
+void LoadGenerator::replay(unsigned thread) {
+	std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> batch;
+	batch.reserve(GENERATION_BATCH);
+
+	auto start = std::chrono::steady_clock::now();
+	size_t index = thread;
+	while (network.running && index < trace->size()) {
+		double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		TraceRecord record = (*trace)[index];
+		while (record.time * 1e-6 / TRACE_SPEED <= now && batch.size() < GENERATION_BATCH) {
+			batch.push_back(std::make_tuple(record.id, 0u, record.size));
+			index += threads;
+			if (index >= trace->size()) break;
+			record = (*trace)[index];
+		}
+		if (batch.size() > 0) {
+			network.addTransactions(batch);
+			if (batch.size() == GENERATION_BATCH) {
+				batch.clear();
+				continue;
+			}
+			batch.clear();
+		}
+		if (index >= trace->size()) break;
+
+		double wait = std::min(record.time * 1e-6 / TRACE_SPEED - now, maximumSleep);
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(now + wait)));
+	}
+}
+
+bool LoadGenerator::available() {
+	if (parseProfile(LOAD_PROFILE) != LoadProfile::Trace || TraceFile(TRACE_FILE).isOpen()) return true;
+	std::cerr << "could not open the trace " << TRACE_FILE << std::endl;
+	return false;
+}
+
+void LoadGenerator::run() {
+	void (LoadGenerator::*loop)(unsigned) = &LoadGenerator::generate;
+	if (profile == LoadProfile::Trace) {
+		if (!trace->isOpen()) {
+			std::cerr << "could not open the trace " << TRACE_FILE << std::endl;
+			return;
+		}
+		loop = &LoadGenerator::replay;
+	}
+
+	std::vector<std::thread> generators;
+	for (unsigned i = 1; i < threads; i++) {
+		generators.push_back(std::thread(loop, this, i));
+	}
+
+	// the calling thread is the first generator
+	(this->*loop)(0);
+	for (std::thread& t : generators) t.join();
+
+	// a replayed trace can end before the simulation, which keeps running without new transactions until it is stopped
+	while (network.running) std::this_thread::sleep_for(std::chrono::duration<double>(maximumSleep));
+}
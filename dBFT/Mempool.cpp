@@ -0,0 +1,53 @@
+// Mempool class holds the transactions a bookkeeper has heard about but not yet seen confirmed.
+// All operations used during a round (insert, erase by id and random selection) take constant time per transaction.
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <random>
+
+#include "Mempool.h"
+#include "Transaction.h"
+
+void Mempool::swap(size_t i, size_t j) {
+	if (i == j) return;
+	std::swap(transactions[i], transactions[j]);
+	indices[transactions[i]->id] = i;
+	indices[transactions[j]->id] = j;
+}
+
+size_t Mempool::size() const {
+	return transactions.size();
+}
+
+bool Mempool::contains(unsigned int id) const {
+	return indices.find(id) != indices.end();
+}
+
+void Mempool::insert(std::shared_ptr<const Transaction> transaction) {
+	if (contains(transaction->id)) return;
+	indices[transaction->id] = transactions.size();
+	transactions.push_back(transaction);
+}
+
+// the erased transaction is swapped to the back so the vector stays dense
+void Mempool::erase(unsigned int id) {
+	auto iter = indices.find(id);
+	if (iter == indices.end()) return;
+	swap(iter->second, transactions.size() - 1);
+	indices.erase(id);
+	transactions.pop_back();
+}
+
+// partial Fisher-Yates shuffle: each pick is moved to the front so it cannot be drawn twice
+std::vector<std::shared_ptr<const Transaction>> Mempool::sample(size_t n, std::mt19937_64& rng) {
+	std::vector<std::shared_ptr<const Transaction>> picked;
+	if (n > transactions.size()) n = transactions.size();
+	picked.reserve(n);
+
+	for (size_t i = 0; i < n; i++) {
+		std::uniform_int_distribution<size_t> dist(i, transactions.size() - 1);
+		swap(i, dist(rng));
+		picked.push_back(transactions[i]);
+	}
+	return picked;
+}
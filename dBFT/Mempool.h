@@ -0,0 +1,33 @@
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <random>
+
+#include "Transaction.h"
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+// a bookkeeper's local memory of unconfirmed transactions
+// transactions are stored densely so any one can be addressed by index, with a lookup from id to index
+class Mempool {
+
+private:
+
+	std::vector<std::shared_ptr<const Transaction>> transactions;
+	std::unordered_map<unsigned int, size_t> indices;
+
+	// exchanges the positions of two transactions, keeping the lookup consistent
+	void swap(size_t i, size_t j);
+
+public:
+
+	size_t size() const;
+	bool contains(unsigned int id) const;
+	void insert(std::shared_ptr<const Transaction> transaction);
+	void erase(unsigned int id);
+	// picks up to n distinct transactions uniformly at random
+	std::vector<std::shared_ptr<const Transaction>> sample(size_t n, std::mt19937_64& rng);
+};
+
+#endif
@@ -1,39 +1,48 @@
 // Merkle trees are a "hash-tree" data structure used to store transactions in a block, with the Merkle root value used in mining.
+// The tree has the shape of RFC 6962's: its left sub-tree holds the largest power of two leaves smaller than the whole,
+// which lets it be built incrementally, keeping only the roots of its complete sub-trees.
 #include <vector>
 #include <string>
 
 #include "MerkleTree.h"
 #include "Transaction.h"
 
-// the tree is stored as a vector, with the children of index n at 2n and 2n+1
-// it is built from the leaves to the root by combining the roots of sub-trees by concatenating the hashes of their values
-MerkleTree::MerkleTree(std::vector<Transaction> transactions) {
-
-	// store the transaction ids 
-	for (Transaction t : transactions) {
-		ids.push_back(t.id);
-	}
+MerkleTree::MerkleTree() {}
 
-	// as binary trees, Merkle trees need an even number of leaves -> we duplicate the last element if this is the case
-	if (transactions.size() % 2 == 1) transactions.push_back(transactions.back());
+MerkleTree::MerkleTree(std::vector<Transaction> transactions) {
+	for (const Transaction& t : transactions) append(t);
+}
 
-	// a library hash function is used here as it is faster than SHA-256
+// the roots of sub-trees are combined by concatenating the hashes of their values
+// a library hash function is used here as it is faster than SHA-256
+std::string MerkleTree::combine(const std::string& left, const std::string& right) {
 	std::hash<std::string> hash;
+	return std::to_string(hash(left)) + std::to_string(hash(right));
+}
 
-	// initially all transactions are hashed to form single-node trees - the leaves of the final tree
-	for (Transaction t : transactions) {
-		hashes.push_back(std::to_string(hash(t.toString())));
-	}
-
-	// in a BST of n leaves there are 2n-1 nodes
-	auto numberOfNodes = 2 * hashes.size() - 1;
-	int i = 0;
-	while (hashes.size() < numberOfNodes) {
-		hashes.push_back(std::to_string(hash(hashes[i])) + std::to_string(hash(hashes[i + 1])));
-		i += 2;
+// amortised constant time: on average one sub-tree is merged per leaf
+void MerkleTree::append(const Transaction& transaction) {
+	ids.push_back(transaction.id);
+	std::string carry = std::to_string(std::hash<std::string>()(transaction.toString()));
+	size_t k = 0;
+	for (; k < peaks.size() && !peaks[k].empty(); k++) {
+		carry = combine(peaks[k], carry);
+		peaks[k].clear();
 	}
+	if (k == peaks.size()) peaks.push_back(carry);
+	else peaks[k] = carry;
 }
 
-std::string MerkleTree::getMerkleRoot() {
-	return hashes.back();
+// the complete sub-trees are joined from the smallest up, each as the right child of the next larger one
+std::string MerkleTree::getMerkleRoot() const {
+
+	// a block without transactions (e.g. proposed once a replayed trace has ended) has the hash of nothing as its root
+	if (ids.empty()) return std::to_string(std::hash<std::string>()(""));
+
+	std::string root;
+	for (const std::string& peak : peaks) {
+		if (peak.empty()) continue;
+		root = (root.empty() ? peak : combine(peak, root));
+	}
+	return root;
 }
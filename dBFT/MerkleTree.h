@@ -6,19 +6,27 @@
 #ifndef MERKLETREE_H
 #define MERKLETREE_H
 
+// an accumulator that can be extended one transaction at a time, e.g. while a speaker waits for transactions
 class MerkleTree {
 
+private:
+
+	// peaks[k] is the root of a complete sub-tree of 2^k leaves, or empty
+	// as in a binary counter, adding a leaf merges the sub-trees of equal size
+	std::vector<std::string> peaks;
+
+	static std::string combine(const std::string& left, const std::string& right);
+
 public:
 
 	// stores the ids of input transactions
 	std::vector<unsigned> ids;
 
-	// stores the hashes of each node of the tree
-	std::vector<std::string> hashes;
-
+	MerkleTree();
 	MerkleTree(std::vector<Transaction> transactions);
 
-	std::string getMerkleRoot();
+	void append(const Transaction& transaction);
+	std::string getMerkleRoot() const;
 
 };
 
@@ -1,9 +1,14 @@
 #include <string>
 #include <sstream>
+#include <iomanip>
+#include <iostream>
 
 #include "Monitor.h"
 #include "Node.h"
 #include "Network.h"
+#include "InstrumentedMutex.h"
+#include "PerfCounters.h"
+#include "Placement.h"
 
 #include <curses.h>
 
@@ -15,7 +20,7 @@ extern const int TRANSACTIONS_TO_SHOW;
 extern const unsigned UNRESPONSIVE_NODES;
 extern const unsigned MALICIOUS_NODES;
 
-Monitor::Monitor(std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>& semaphores): semaphores(semaphores) {
+Monitor::Monitor(BroadcastLog& semaphores): semaphores(semaphores) {
 	flagStrings[Semaphore::PrepareRequest] = "PREPARE_REQUEST";
 	flagStrings[Semaphore::PrepareResponse] = "PREPARE_RESPONSE";
 	flagStrings[Semaphore::ChangeView] = "CHANGE_VIEW";
@@ -23,6 +28,8 @@ Monitor::Monitor(std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>&
 }
 
 void Monitor::display(std::vector<Node*> nodes, std::vector<std::tuple<unsigned, time_t, time_t>>* recentConfirmations) {
+	Placement::pin("monitor", 0);
+	PerfCounters::attach("monitor", 0);
 
 	// initialize the console for curses
 	initscr();
@@ -80,6 +87,10 @@ void Monitor::display(std::vector<Node*> nodes, std::vector<std::tuple<unsigned,
 	// continuously refresh data
 	while (true) {
 
+		// lock statistics and performance counters requested by signal go to the error stream, which should be redirected away from the display
+		InstrumentedMutex::poll(std::cerr);
+		PerfCounters::poll(std::cerr);
+
 		try {
 
 			// get most recently confirmed transactions
@@ -105,9 +116,7 @@ void Monitor::display(std::vector<Node*> nodes, std::vector<std::tuple<unsigned,
 
 			// refresh message queue table
 			for (unsigned i = 0; i < NUMBER_OF_NODES; i++) {
-				Node::s.lock();
-				auto flags = semaphores[i];
-				Node::s.unlock();
+				auto flags = semaphores.unread(i, static_cast<size_t>(messageWidth));
 				for (int j = 0; j < static_cast<int>(flags.size()); j++) {
 					ss << flagStrings[std::get<0>(flags[j])] << "  ";
 				}
@@ -127,7 +136,7 @@ void Monitor::display(std::vector<Node*> nodes, std::vector<std::tuple<unsigned,
 				ss << "    " << (nodes[i]->speaker ? "SPEAKER " : "DELEGATE");
 				ss << "    " << (nodes[i]->responsive ? "TRUE " : "FALSE");
 				ss << "    " << (nodes[i]->honest ? "TRUE " : "FALSE");
-				ss << "    " << nodes[i]->activity;
+				ss << "    " << std::left << std::setw(20) << describe(nodes[i]->activity.current);
 				ss << " " << workingHash;
 				mvwprintw(nodesWin, i + 2, 1, ss.str().c_str());
 				ss.str("");
@@ -1,6 +1,7 @@
 #include <vector>
 
 #include "Node.h"
+#include "BroadcastLog.h"
 
 #ifndef MONITOR_H
 #define MONITOR_H
@@ -8,10 +9,10 @@
 class Monitor
 {
 public:
-	Monitor(std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>& semaphores);
+	Monitor(BroadcastLog& semaphores);
 	void display(std::vector<Node*> nodes, std::vector<std::tuple<unsigned, time_t, time_t>>* recentConfirmations);
 private:
-	std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>& semaphores;
+	BroadcastLog& semaphores;
 	std::map<Semaphore, std::string> flagStrings;
 };
 
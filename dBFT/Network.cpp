@@ -7,64 +7,91 @@
 #include <iostream>
 
 #include "Network.h"
+#include "LoadGenerator.h"
 #include "Transaction.h"
+#include "PerfCounters.h"
+#include "Placement.h"
 
 extern const double TRANSACTION_FREQUENCY;
 extern const int TRANSACTIONS_TO_SHOW;
+extern const unsigned POOL_SHARDS;
 
-std::mutex Network::r;
+InstrumentedMutex Network::r("Network::r");
 
-// setup random number generator for transactions
-Network::Network() {
-	std::random_device rd;
-	rng = std::mt19937_64(rd());
+Network::Network() :pool(POOL_SHARDS) {
+	running = true;
+	bytesSent = 0;
 }
 
 // populates the unconfirmed transaction pool 
 void Network::generateTransactions() {
-	std::uniform_int_distribution<unsigned int> dist(1, 100000);
+	Placement::pin("generator", 0);
+	PerfCounters::attach("generator", 0);
+	LoadGenerator generator(*this);
+	generator.run();
+}
 
-	unsigned long id = 0;
-	while (true) {
-		Transaction* t = new Transaction(id, dist(rng), dist(rng));
-		p.lock();
-		pool.push_back(t);
-		p.unlock();
-		id++;
-		std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(TRANSACTION_FREQUENCY * 1000)));
-	}
+// transaction ids are their index in the pool, assigned as they are added
+void Network::addTransactions(const std::vector<std::tuple<unsigned int, unsigned int, unsigned int>>& transfers) {
+	std::vector<std::shared_ptr<Transaction>> batch;
+	batch.reserve(transfers.size());
+	for (auto& transfer : transfers) batch.push_back(std::make_shared<Transaction>(0, std::get<0>(transfer), std::get<1>(transfer), std::get<2>(transfer)));
+	pool.add(batch);
+}
+
+static std::shared_ptr<const Transaction> share(std::shared_ptr<Transaction>& entry) {
+	return entry;
 }
 
 // where consensus nodes spend wait time 
-Transaction* Network::receiveTransaction(unsigned long* counter) {
+// reads on through the ids below the pool's size when called, which every shard holds, so no transaction is skipped
+std::shared_ptr<const Transaction> Network::receiveTransaction(unsigned long* counter) {
 	unsigned long c = *counter;
-	while (c < pool.size()) {
-		if (pool[c] != nullptr) {
-			*counter = c+1;
-			return pool[c];
+	unsigned long end = pool.size();
+	while (c < end) {
+		std::shared_ptr<const Transaction> t = pool.with(static_cast<unsigned int>(c++), share);
+		if (t != nullptr) {
+			*counter = c;
+			return t;
 		}
-		c++;
 	}
+	*counter = c;
 	return nullptr;
 }
 
+// used by nodes completing a compact proposal
+std::shared_ptr<const Transaction> Network::findTransaction(unsigned int id) {
+	return pool.with(id, share);
+}
+
 // finality guarantees of dBFT means we can confirm transactions after one node calls this function
 // when collecting data on block times in presence of faults, add output to this function
 void Network::confirmTransactions(std::vector<Transaction>& transactions) {
 	for (Transaction transaction : transactions) {
-		Transaction* t = pool[transaction.id];
 
-		// return if another node has already notified the network
-		if (t == nullptr) return;
-		p.lock();
+		// taken out of the pool by the first node to notify the network, others skip it
+		// bookkeepers may still hold the transaction in local memory, it is freed once they release it
+		std::shared_ptr<Transaction> t = pool.with(transaction.id, [](std::shared_ptr<Transaction>& entry) {
+			std::shared_ptr<Transaction> taken = entry;
+			entry = nullptr;
+			return taken;
+		});
+		if (t == nullptr) continue;
 		t->confirm();
 
 		// add to the list of recently confirmed transactions
 		r.lock();
 		if (recentConfirmations.size() == TRANSACTIONS_TO_SHOW) recentConfirmations.erase(recentConfirmations.begin());
 		recentConfirmations.push_back(std::make_tuple(t->id, t->creationTime, t->confirmationTime));
+		latencies.push_back(t->confirmationTime - t->creationTime);
 		r.unlock();
-		delete t;
-		p.unlock();
 	}
 }
+
+void Network::recordTransfer(size_t bytes) {
+	bytesSent += bytes;
+}
+
+void Network::stop() {
+	running = false;
+}
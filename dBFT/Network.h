@@ -3,9 +3,14 @@
 #include <random>
 #include <string>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <tuple>
 
 #include "Transaction.h"
 #include "Block.h"
+#include "InstrumentedMutex.h"
+#include "TransactionPool.h"
 
 #ifndef NETWORK_H
 #define NETWORK_H
@@ -14,22 +19,31 @@ class Network {
 
 private:
 
-	std::mt19937_64 rng;
-	std::mutex p; // protects pool
-	std::vector<Transaction*> pool;
+	TransactionPool<std::shared_ptr<Transaction>> pool;
 
 
 public:
 
 	Network();
-	static std::mutex r; // protects recent confirmations
+	static InstrumentedMutex r; // protects recent confirmations and latencies
 	std::vector<std::tuple<unsigned, time_t, time_t>> recentConfirmations;
+	std::vector<time_t> latencies; // time from creation to confirmation of every confirmed transaction
+	std::atomic<bool> running; // cleared to shut the simulation down
+	std::atomic<unsigned long long> bytesSent; // bytes that messages between nodes would take on a real network
 	// network thread fills pool with transactions
 	void generateTransactions(); 
-	// nodes call this to iterate over map and copy transactions into local memory
-	Transaction* receiveTransaction(unsigned long* counter); 
+	// adds a batch of transactions (input, output, size) to the pool, taking each shard's lock once
+	void addTransactions(const std::vector<std::tuple<unsigned int, unsigned int, unsigned int>>& transfers);
+	// nodes call this to iterate over the pool and share transactions into local memory
+	std::shared_ptr<const Transaction> receiveTransaction(unsigned long* counter); 
+	// returns the transaction with the given id, or nullptr if it has been confirmed
+	std::shared_ptr<const Transaction> findTransaction(unsigned int id);
 	// called by nodes when blocks are agreed to tell the network the transactions are confirmed (output timestamps)
 	void confirmTransactions(std::vector<Transaction>& transactions);
+	// counts the bytes of a message sent between nodes
+	void recordTransfer(size_t bytes);
+	// stops transaction generation and tells nodes to finish
+	void stop();
 };
 
 #endif
@@ -14,30 +14,34 @@
 #include "Transaction.h"
 #include "Network.h"
 #include "Semaphore.h"
+#include "Mempool.h"
+#include "VoteAggregator.h"
+#include "BroadcastLog.h"
+#include "Proposal.h"
+#include "MerkleTree.h"
+#include "Serialization.h"
+#include "Timeline.h"
+#include "PerfCounters.h"
+#include "Placement.h"
 
 extern const int BLOCK_SIZE;
 extern const int BLOCK_TIME;
 extern const unsigned NUMBER_OF_NODES;
 extern const bool RANDOM_SPEAKER;
-
-std::mutex Node::s;
-std::mutex Node::b;
-std::mutex Node::r;
-
-int Node::highestRound = -1;
-int Node::highestView = -1;
-
-int Node::getRandomSpeaker(int height, int view) {
-	unsigned speaker;
-	r.lock();
-	srand(height + view);
-	speaker = rand() % NUMBER_OF_NODES;
-	r.unlock();
-	return speaker;
+extern const char* const SPEAKER_STAKES;
+extern const bool PIPELINED_CONSENSUS;
+extern const bool COMPACT_PROPOSALS;
+extern const bool FAST_VIEW_CHANGE;
+extern const bool INCREMENTAL_PROPOSALS;
+extern const bool SPECULATIVE_PROPOSALS;
+
+bool Node::isSpeaker(int height, int view, const std::string& previousHash) {
+	if (RANDOM_SPEAKER) return schedule.speaker(previousHash, height, view) == id;
+	return (height - view) % NUMBER_OF_NODES == id;
 }
 
-Node::Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>& semaphores, Block* fullBlock, std::pair<std::vector<Transaction>, std::string>* proposal, bool responsive, bool honest) :
-	id(id), network(network), semaphores(semaphores), fullBlock(fullBlock), proposal(proposal), responsive(responsive), honest(honest) {
+Node::Node(unsigned int id, Network& network, BroadcastLog& semaphores, VoteAggregator& votes, bool responsive, bool honest) :
+	id(id), network(network), semaphores(semaphores), votes(votes), responsive(responsive), honest(honest), activity(id), schedule(NUMBER_OF_NODES, SPEAKER_STAKES) {
 	
 	// initialize random number generator
 	std::random_device rd;
@@ -46,129 +50,210 @@ Node::Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple
 	// add a genesis block 
 	Block genesisBlock;
 	blockchain.push_back(genesisBlock);
+
+	// only nodes taking part in consensus hold back the discarding of old votes
+	if (responsive) votes.advance(id, blockHeight);
 }
 
 void Node::broadcast(std::tuple<Semaphore, int, int, int> message) {
-	activity = "BROADCASTING MESSAGE";
-	for (unsigned i = 0; i < NUMBER_OF_NODES; i++) {
-		// std::vector may change position in memory when adding/erasing elements so must be read atomically
-		s.lock();
-		semaphores[i].push_back(message);
-		s.unlock();
-	}
+	activity.set(Activity::BroadcastingMessage);
+
+	// the vote is counted once for everyone, the messages themselves wake nodes waiting for a proposal
+	// a vote that has already been counted (e.g. a block published by another node) is not sent again
+	if (!votes.record(std::get<1>(message), std::get<2>(message), std::get<0>(message), std::get<3>(message))) return;
+
+	// written once, each node reads it from its own position in the log
+	// on a real network it would be sent to every other node
+	semaphores.append(message);
+	network.recordTransfer(MESSAGE_SIZE * (NUMBER_OF_NODES - 1));
+	Timeline::sent(id, describe(std::get<0>(message)), std::get<1>(message), std::get<2>(message), -1);
 }
 
 bool Node::filterMessage(){
 
-	s.lock();
-	int h = std::get<1>(semaphores[id][0]);
-	int v = std::get<2>(semaphores[id][0]);
-	s.unlock();
+	std::tuple<Semaphore, int, int, int> message;
+	if (!semaphores.peek(id, message)) return false;
+	int h = std::get<1>(message);
+	int v = std::get<2>(message);
 
 	// if the message is from a node still working at an old block height
 	if (h < blockHeight ||
 		// or the same block height but an old view
 		(h == blockHeight && v < view)) {
 		// delete their message
-		s.lock();
-		semaphores[id].erase(semaphores[id].begin());
-		s.unlock();
+		semaphores.pop(id);
 		return false;
 	}
+	Timeline::received(id, describe(std::get<0>(message)), h, v, std::get<3>(message));
 	return true;
 }
 
 // node checks if the current round has timed out
 bool Node::timedOut() {
 	time_t t = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - viewStart;
-	return t > pow(2, view + 1) * BLOCK_TIME * 1000;
+	return t > viewTimeout();
+}
+
+// 2^(view + 1) block times, the shift is bounded so that late views do not overflow
+time_t Node::viewTimeout() {
+	return (static_cast<time_t>(2) << std::min(view, 30)) * BLOCK_TIME * 1000;
+}
+
+// the time at which the current view times out
+std::chrono::system_clock::time_point Node::viewDeadline() {
+	return std::chrono::system_clock::time_point(std::chrono::milliseconds(viewStart + viewTimeout()));
+}
+
+bool Node::viewAbandoned() {
+	return FAST_VIEW_CHANGE && votes.abandonedView(blockHeight) >= view;
+}
+
+// once more than f nodes have asked to leave a view, at least one of them is honest and the view cannot be relied on,
+// so the node moves on instead of waiting for its own timeout
+bool Node::followViewChange() {
+	if (!viewAbandoned()) return false;
+	int abandoned = votes.abandonedView(blockHeight);
+
+	// the node adds its own request so that nodes still waiting on the view see a quorum
+	broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::ChangeView, blockHeight, view, id));
+	view = abandoned + 1;
+	viewChanges++;
+	return true;
 }
 
 void Node::wait(bool speaker) {
-	activity = "MONITORING NETWORK  ";
+	activity.set(Activity::MonitoringNetwork);
+
+	// a candidate is kept through view changes at the same height, since none of its transactions have been confirmed
+	if (((speaker && INCREMENTAL_PROPOSALS) || SPECULATIVE_PROPOSALS) && candidateHeight != blockHeight) startCandidate();
 
+	// a speaker taking over after a view change has already waited a block time in earlier views
+	// so it proposes from the transactions collected so far, after catching up with the pool
+	if (speaker && FAST_VIEW_CHANGE && view > 0 && bookkeeperMemory.size() > 0) {
+		std::shared_ptr<const Transaction> t;
+		while ((t = network.receiveTransaction(&transactionCounter)) != nullptr) collect(t);
+	}
 	// if the node is the speaker, listen for transactions until the waiting period is over
-	if (speaker) {
+	else if (speaker) {
 		time_t until = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() + BLOCK_TIME * 1000;
-		while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() < until) {
-			Transaction* t = network.receiveTransaction(&transactionCounter);
-			if (t != nullptr) {
-				Transaction copy(*t);
-				bookkeeperMemory[copy.id] = copy;
-			}
+		while (network.running && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() < until) {
+			if (viewAbandoned()) break;
+			std::shared_ptr<const Transaction> t = network.receiveTransaction(&transactionCounter);
+			if (t != nullptr) collect(t);
 		}
 	} 
 	// otherwise receive transactions until the speaker prepares a proposal
 	else {
-		while (true) {
-			s.lock();
-			auto size = semaphores[id].size();
-			s.unlock();
-
-			if(size != 0 && filterMessage()) break;
+		while (network.running) {
+			if (filterMessage()) break;
 			if (timedOut()) break;
-			Transaction* t = network.receiveTransaction(&transactionCounter);
-			if (t != nullptr) {
-				Transaction copy(*t);
-				bookkeeperMemory[copy.id] = copy;
-			}
+			if (viewAbandoned()) break;
+			std::shared_ptr<const Transaction> t = network.receiveTransaction(&transactionCounter);
+			if (t != nullptr) collect(t);
 		}
 	}
 }
 
-void Node::proposeBlock() {
-	activity = "PUBLISHING PROPOSAL ";
-
-	// pick some random transactions from memory
-	// initialise vars
-	std::uniform_int_distribution<unsigned int> dist(0, (int) bookkeeperMemory.size()-1);
-	std::vector<Transaction> transactions;
-	std::map<unsigned, bool> collected;
-
-	// collect transactions
-	for (int i = 0; i < BLOCK_SIZE; i++) {
-		std::map<unsigned int, Transaction>::iterator iter = bookkeeperMemory.begin();
-		unsigned id = dist(rng);
-
-		// avoid duplicates 
-		std::advance(iter, dist(rng));
-		if (collected[iter->second.id]) continue;
-		collected[iter->second.id] = true;
-		transactions.push_back(iter->second);
+void Node::collect(std::shared_ptr<const Transaction> transaction) {
+	if (bookkeeperMemory.contains(transaction->id)) return;
+	bookkeeperMemory.insert(transaction);
+	if (candidateHeight == blockHeight && candidate.size() < static_cast<size_t>(BLOCK_SIZE)) {
+		candidate.push_back(*transaction);
+		candidateTree.append(*transaction);
+	}
+}
+
+void Node::startCandidate() {
+	candidate.clear();
+	candidateTree = MerkleTree();
+	candidateHeight = blockHeight;
+	for (std::shared_ptr<const Transaction> t : bookkeeperMemory.sample(BLOCK_SIZE, rng)) {
+		candidate.push_back(*t);
+		candidateTree.append(*t);
+	}
+}
+
+std::shared_ptr<const Proposal> Node::proposeBlock(int height, int view, std::string previousHash) {
+	activity.set(Activity::PublishingProposal);
+
+	// a candidate built while waiting only needs the block hash computing
+	std::shared_ptr<const Proposal> p;
+	if (height == candidateHeight) p = std::make_shared<const Proposal>(previousHash, candidate, candidateTree, honest);
+
+	// otherwise pick some random transactions from memory
+	else {
+		std::vector<Transaction> transactions;
+		for (std::shared_ptr<const Transaction> t : bookkeeperMemory.sample(BLOCK_SIZE, rng)) {
+			transactions.push_back(*t);
+		}
+		p = std::make_shared<const Proposal>(previousHash, transactions, honest);
 	}
 
 	// publish a block proposal
-	std::string hash = (honest ? Block(blockchain.back().hash, transactions).hash : "");
-	*proposal = std::pair<std::vector<Transaction>, std::string>(transactions, hash);
+	votes.getTally(height, view)->setProposal(p);
+	network.recordTransfer(p->transferSize(COMPACT_PROPOSALS) * (NUMBER_OF_NODES - 1));
 
 	// notify the delegates
-	broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::PrepareRequest, blockHeight, view, id));
+	broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::PrepareRequest, height, view, id));
+	return p;
+}
+
+// in pipelined mode the speaker of the next height proposes as soon as the current proposal is prepared,
+// building on the block about to be committed so that collection for the next height overlaps the commit
+void Node::proposeNextBlock() {
+	if (!isSpeaker(blockHeight + 1, 0, proposal->getBlock().hash)) return;
+
+	// the prepared transactions will be committed, so must not be proposed again
+	for (const Transaction& t : proposal->transactions) {
+		bookkeeperMemory.erase(t.id);
+	}
+
+	// with nothing new to propose the next round waits for transactions as usual
+	if (bookkeeperMemory.size() == 0) return;
+	proposeBlock(blockHeight + 1, 0, proposal->getBlock().hash);
 }
 
 void Node::validateProposal() {
-	activity = "VALIDATING PROPOSAL ";
+	activity.set(Activity::ValidatingProposal);
 
-	s.lock();
-	auto size = semaphores[id].size();
-	auto flag = std::get<0>(semaphores[id][0]);
-	s.unlock();
+	std::tuple<Semaphore, int, int, int> message;
+	bool received = semaphores.peek(id, message);
+	proposal = votes.getTally(blockHeight, view)->getProposal();
 
 	// check that the block is valid (hash of transactions and own previous hash equals hash sent)
-	if (size > 0 && flag == Semaphore::PrepareRequest && 
-		Block(blockchain.back().hash, std::get<0>(*proposal)).hash == std::get<1>(*proposal)) {
+	// a compact proposal can only be checked once its transactions have been found
+	if (received && std::get<0>(message) == Semaphore::PrepareRequest && 
+		proposal != nullptr && (!COMPACT_PROPOSALS || reconstructProposal(*proposal)) && proposal->isValid(blockchain.back().hash)) {
 		broadcast(std::tuple<Semaphore, int, int, int>((honest ? Semaphore::PrepareResponse : Semaphore::ChangeView), blockHeight, view, id));
 	}
 	// else request a view change 
 	else broadcast(std::tuple<Semaphore, int, int, int>((honest ? Semaphore::ChangeView : Semaphore::PrepareResponse), blockHeight, view, id));
 }
 
+// transactions not yet heard of are requested from the speaker, costing a round trip
+bool Node::reconstructProposal(const Proposal& proposal) {
+	size_t missing = 0;
+	size_t payload = 0;
+	for (const Transaction& t : proposal.transactions) {
+		if (bookkeeperMemory.contains(t.id)) continue;
+		std::shared_ptr<const Transaction> found = network.findTransaction(t.id);
+		if (found == nullptr) return false;
+		bookkeeperMemory.insert(found);
+		missing++;
+		payload += found->size;
+	}
+	if (missing > 0) network.recordTransfer(2 * MESSAGE_SIZE + missing * (4 + TransactionView::SIZE) + payload);
+	return true;
+}
+
 void Node::addBlock() {
-	activity = "ADDING BLOCK        ";
+	activity.set(Activity::AddingBlock);
 	blockHeight++;
-	blockchain.push_back(*fullBlock);
+	votes.advance(id, blockHeight);
+	blockchain.push_back(proposal->getBlock());
 
 	// notify the rest of the network which transactions are now final
-	std::vector<Transaction> confirmedTransactions = proposal->first;
+	std::vector<Transaction> confirmedTransactions = proposal->transactions;
 	if(speaker) network.confirmTransactions(confirmedTransactions);
 
 	// delete the transactions from local memory
@@ -178,160 +263,83 @@ void Node::addBlock() {
 }
 
 void Node::publishFullBlock() {
-	activity = "PUBLISHING BLOCK    ";
-	b.lock();
-	// publish a block if this node is the first to reach detect consensus
-	if (fullBlock->hash != proposal->second) {
-		*fullBlock = Block(blockchain.back().hash, proposal->first);
-		broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::BlockPublished, blockHeight, view, id));
-	}
-	b.unlock();
+	activity.set(Activity::PublishingBlock);
+	// announce the block if this node is the first to detect consensus (otherwise broadcast sends nothing)
+	broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::BlockPublished, blockHeight, view, id));
 	addBlock();
 }
 
 bool Node::listenForResponses() {
-	activity = "RECEIVING RESPONSES ";
-	double supermajority = 2.0 / 3.0;
-	unsigned approvals = 0;
-	unsigned rejections = 0;
-	bool response = false;
-
-	// arrays to check nodes are not sending multiple responses
-	// approving nodes can however later request a view change 
-	// progression still only occurs if a 2/3 majority is reached, preserving safety properties
-	int* receivedApprovals = new int[NUMBER_OF_NODES];
-	int* receivedRejections = new int[NUMBER_OF_NODES];
-
-	// initialize arrays to zero
-	for (unsigned i = 0; i < NUMBER_OF_NODES; i++) {
-		receivedApprovals[i] = 0;
-		receivedRejections[i] = 0;
+	activity.set(Activity::ReceivingResponses);
+
+	// every node's vote for this height and view is counted once in the shared tally
+	std::shared_ptr<VoteAggregator::Tally> tally = votes.getTally(blockHeight, view);
+	tally->await(viewDeadline(), FAST_VIEW_CHANGE);
+
+	// if a majority approves (or a block has already been published) consensus has been reached
+	// nodes that timed out before validating still commit the block that the majority verified
+	if (tally->approved() || tally->isPublished()) {
+		proposal = tally->getProposal();
+		if (proposal == nullptr) return false;
+		if (PIPELINED_CONSENSUS && tally->approved()) proposeNextBlock();
+		publishFullBlock();
+		return true;
 	}
 
-	while (approvals + rejections < NUMBER_OF_NODES) {
-		s.lock();
-		auto size = semaphores[id].size();
-		s.unlock();
-
-		if (size > 0) {
-
-			// retrieve message data 
-			s.lock();
-			int senderHeight = std::get<1>(semaphores[id][0]);
-			int senderView = std::get<2>(semaphores[id][0]);
-			unsigned senderID = std::get<3>(semaphores[id][0]);
-			s.unlock();
-
-			if (senderHeight == blockHeight && senderView == view) {
-				s.lock();
-				auto flag = std::get<0>(semaphores[id][0]);
-				s.unlock();
-
-				switch (flag) {
-
-				// the speaker backs their own proposal
-				case Semaphore::PrepareRequest:
-					if (receivedApprovals[senderID] == 0) {
-						receivedApprovals[senderID] = 1;
-						approvals++;
-					}
-					break;
-
-				// response of a delegate that approves of the proposal
-				case Semaphore::PrepareResponse:
-					if (receivedApprovals[senderID] == 0) {
-						receivedApprovals[senderID] = 1;
-						approvals++;
-					}
-					break;
-
-				// if a node rejects the proposal they request a view change
-				// (with the next view having a different speaker)
-				case Semaphore::ChangeView:
-					if (receivedRejections[senderID] == 0) {
-						receivedRejections[senderID] = 1;
-						rejections++;
-					}
-					break;
-
-				// if a block has been published consensus has been reached 
-				case Semaphore::BlockPublished:
-					addBlock();
-					response = true;
-
-					// remove read message from queue if about to exit
-					s.lock();
-					semaphores[id].erase(semaphores[id].begin());
-					s.unlock();
-					goto exit;
-				}
-			}
-
-			// remove read message from queue
-			// since the wait of time t occurs each view, messages of different views should not be interleaved
-			s.lock();
-			semaphores[id].erase(semaphores[id].begin());
-			s.unlock();
-
-			// check for a majority in either direction
-			// note: use of goto here is the neatest solution to exit the nested loop and is used pragmatically, rather than avoiding it on principle
-			if (approvals > supermajority * NUMBER_OF_NODES) {
-				publishFullBlock();
-				response = true;
-				goto exit;
-			}
-
-			if (rejections > supermajority * NUMBER_OF_NODES) {
-				response = false;
-				goto exit;
-			}
-		}
+	// a majority rejecting the proposal, or every node having responded without a majority, leads to a view change
+	if (tally->decided()) return false;
 
-		// node will request a view change if the round of consensus times out 
-		else if(timedOut()) {
-			broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::ChangeView, blockHeight, view, id));
-			response = false;
-			goto exit;
-		}
-	}
-	exit:
-	delete receivedApprovals;
-	delete receivedRejections;
-	return response;
+	// as does more than f nodes giving up on the view, which the caller joins
+	if (viewAbandoned()) return false;
+
+	// a node woken because the simulation stopped has not timed out, so does not ask for a view change
+	if (!network.running) return false;
+
+	// node will request a view change if the round of consensus times out
+	broadcast(std::tuple<Semaphore, int, int, int>(Semaphore::ChangeView, blockHeight, view, id));
+	return false;
 }
 
 void Node::round() {
-	activity = "INITIALISING ROUND  ";
+	activity.set(Activity::InitialisingRound);
 	// reset the view index
 	view = 0;
 	
-	bool consensusReached = false;
-	while (true) {		
+	while (network.running) {		
 		
 		// record the view start time 
 		viewStart = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
 		// determine the speaker node 
-		if (RANDOM_SPEAKER) speaker = getRandomSpeaker(blockHeight, view) == id;
-		else speaker = (blockHeight - view) % NUMBER_OF_NODES == id;
+		speaker = isSpeaker(blockHeight, view, blockchain.back().hash);
+
+		// the speaker may already have proposed while the previous block was committed (pipelined mode)
+		std::shared_ptr<const Proposal> pipelined = (speaker ? votes.getTally(blockHeight, view)->getProposal() : nullptr);
 
 		// wait - should be long compared to time for consensus
-		wait(speaker);
+		if (pipelined == nullptr) wait(speaker);
+		if (!network.running) break;
+		if (followViewChange()) continue;
 
 		// commence consensus
-		if (speaker) proposeBlock();
+		if (speaker) proposal = (pipelined != nullptr ? pipelined : proposeBlock(blockHeight, view, blockchain.back().hash));
 		else if(!timedOut()) validateProposal();
 	
 		// await a majority
 		bool consensus = listenForResponses();
-		if (consensus) break;
-		else view++;
+		if (consensus || !network.running) break;
+		if (followViewChange()) continue;
+		view++;
+		viewChanges++;
 	}
 }
 
 void Node::run() {
-	activity = "NONE                ";
-	while (responsive) {
+	Placement::pin("node", id);
+	PerfCounters::attach("node", id);
+	activity.set(Activity::None);
+	while (responsive && network.running) {
 		round();
 	}
+	semaphores.unsubscribe(id);
 }
@@ -1,11 +1,19 @@
 #include <vector>
 #include <mutex>
 #include <random>
+#include <chrono>
 
 #include "Block.h"
 #include "Transaction.h"
 #include "Network.h"
 #include "Semaphore.h"
+#include "Activity.h"
+#include "InstrumentedMutex.h"
+#include "Mempool.h"
+#include "VoteAggregator.h"
+#include "BroadcastLog.h"
+#include "Proposal.h"
+#include "SpeakerSchedule.h"
 
 #ifndef NODE_H
 #define NODE_H
@@ -17,18 +25,22 @@ private:
 	Network& network;
 
 	std::mt19937_64 rng;
-	unsigned long transactionCounter; // records from which point to continue listening for transactions each round 
+	unsigned long transactionCounter = 0; // records from which point to continue listening for transactions each round 
 
 	// local memory
 	time_t viewStart;
-	std::map<unsigned int, Transaction> bookkeeperMemory;
+	Mempool bookkeeperMemory;
+	// the block this node would propose at candidateHeight, extended as transactions arrive so that it is ready once the wait ends
+	std::vector<Transaction> candidate;
+	MerkleTree candidateTree;
+	int candidateHeight = -1;
+	std::shared_ptr<const Proposal> proposal; // the proposal of the current view
 
 	// shared memory
-	std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>& semaphores;
-	Block* fullBlock;
-	std::pair<std::vector<Transaction>, std::string>* proposal;
+	BroadcastLog& semaphores;
+	VoteAggregator& votes;
 
-	// send a message to all other threads message queues
+	// send a message to all nodes, including this one
 	void broadcast(std::tuple<Semaphore, int, int, int> message);
 	// executes a round of consensus
 	void round();
@@ -37,20 +49,35 @@ private:
 	bool filterMessage();
 	// returns true if round has timed out
 	bool timedOut();
+	// milliseconds the current view lasts before timing out, doubling with every view change
+	time_t viewTimeout();
+	std::chrono::system_clock::time_point viewDeadline();
+	// returns true if more than f nodes have asked to leave the current view or a later one
+	bool viewAbandoned();
+	// joins a view change that more than f nodes have asked for, returns false if there is none
+	bool followViewChange();
 	// node monitors network transactions for time BLOCK_TIME each round
 	void wait(bool speaker);
+	// adds a transaction heard of while waiting to local memory, and to the candidate block while it has room
+	void collect(std::shared_ptr<const Transaction> transaction);
+	// starts a candidate block for the current height from a random selection of the transactions in memory
+	void startCandidate();
 	// the speaker creates and broadcasts a block proposal
-	void proposeBlock();
+	std::shared_ptr<const Proposal> proposeBlock(int height, int view, std::string previousHash);
+	// in pipelined mode, the next speaker proposes once the current proposal is prepared
+	void proposeNextBlock();
 	// the delegates validate the proposal
 	void validateProposal();
-	// all nodes count responses to see if a majority exists 
+	// fetches the transactions of a compact proposal missing from local memory, returns false if any cannot be found
+	bool reconstructProposal(const Proposal& proposal);
+	// all nodes wait for the shared tally of responses to show a majority
 	bool listenForResponses();
-	// if there are a majority of prepare responses publish a full block
+	// if there are a majority of prepare responses publish the proposed block
 	void publishFullBlock();
 	// and add the new block to the blockchain
 	void addBlock();
-	// updates the random speaker, when enabled
-	static int getRandomSpeaker(int height, int view);
+	// returns true if this node is the speaker at the given height and view, building on the given block
+	bool isSpeaker(int height, int view, const std::string& previousHash);
 	
 public:
 
@@ -58,22 +85,15 @@ public:
 	const unsigned int id;
 	bool responsive;
 	bool honest;
-	std::string activity;
+	ActivityState activity;
 	std::vector<Block> blockchain;
 	int blockHeight = 0;
 	int view;
 	bool speaker;
+	unsigned viewChanges = 0;
+	const SpeakerSchedule schedule; // used to elect the speaker when RANDOM_SPEAKER is set
 
-	// variables to store data when using random speaker
-	static int highestRound;
-	static int highestView;
-	static int randomSpeaker;
-
-	static std::mutex s; // to protect the semaphore array
-	static std::mutex b; // to protect the shared block 
-	static std::mutex r; // protects RNG used for random speaker mode
-
-	Node(unsigned int id, Network& network, std::vector<std::vector<std::tuple<Semaphore, int, int, int>>>& semaphores, Block* fullBlock, std::pair<std::vector<Transaction>, std::string>* proposal, bool responsive, bool honest);
+	Node(unsigned int id, Network& network, BroadcastLog& semaphores, VoteAggregator& votes, bool responsive, bool honest);
 
 	void run();
 };
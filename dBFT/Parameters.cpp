@@ -0,0 +1,30 @@
+// reads overrides of the simulation constants from the environment
+#include <cstdlib>
+#include <string>
+
+#include "Parameters.h"
+
+int parameter(const char* name, int value) {
+	const char* override = std::getenv(name);
+	return (override != nullptr ? std::stoi(override) : value);
+}
+
+unsigned parameter(const char* name, unsigned value) {
+	const char* override = std::getenv(name);
+	return (override != nullptr ? static_cast<unsigned>(std::stoul(override)) : value);
+}
+
+double parameter(const char* name, double value) {
+	const char* override = std::getenv(name);
+	return (override != nullptr ? std::stod(override) : value);
+}
+
+bool parameter(const char* name, bool value) {
+	const char* override = std::getenv(name);
+	return (override != nullptr ? std::string(override) == "1" || std::string(override) == "true" : value);
+}
+
+const char* parameter(const char* name, const char* value) {
+	const char* override = std::getenv(name);
+	return (override != nullptr ? override : value);
+}
@@ -0,0 +1,12 @@
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+// simulation constants may be overridden by an environment variable of the same name (e.g. when sweeping configurations)
+// otherwise the given default value is returned
+int parameter(const char* name, int value);
+unsigned parameter(const char* name, unsigned value);
+double parameter(const char* name, double value);
+bool parameter(const char* name, bool value);
+const char* parameter(const char* name, const char* value);
+
+#endif
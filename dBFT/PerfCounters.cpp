@@ -0,0 +1,141 @@
+// PerfCounters class reads the processor's own counters for each thread, so that time spent hashing can be told apart
+// from time lost to cache misses, polling and being descheduled, without any external profiler.
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <csignal>
+#include <cerrno>
+#include <iostream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "PerfCounters.h"
+
+extern const bool PERF_COUNTERS;
+
+std::vector<PerfCounters::Counters> PerfCounters::attached;
+std::mutex PerfCounters::m;
+
+static volatile std::sig_atomic_t summaryRequested = 0;
+
+PerfSample& PerfSample::operator+=(const PerfSample& other) {
+	cycles += other.cycles;
+	instructions += other.instructions;
+	cacheMisses += other.cacheMisses;
+	branchMisses += other.branchMisses;
+	contextSwitches += other.contextSwitches;
+	return *this;
+}
+
+std::string PerfSample::toString() const {
+	std::stringstream ss;
+	ss << "{\"cycles\": " << cycles;
+	ss << ", \"instructions\": " << instructions;
+	ss << ", \"instructions_per_cycle\": " << (cycles > 0 ? static_cast<double>(instructions) / cycles : 0);
+	ss << ", \"cache_misses\": " << cacheMisses;
+	ss << ", \"branch_misses\": " << branchMisses;
+	ss << ", \"context_switches\": " << contextSwitches;
+	ss << "}";
+	return ss.str();
+}
+
+bool PerfCounters::enabled() {
+	return PERF_COUNTERS;
+}
+
+#ifdef __linux__
+// counts the calling thread, and threads it starts from now on, in user space
+static int openCounter(unsigned type, unsigned long long config) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.inherit = 1;
+	attr.exclude_kernel = (type == PERF_TYPE_HARDWARE ? 1 : 0);
+	attr.exclude_hv = 1;
+	return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+void PerfCounters::attach(const char* role, int index) {
+	if (!enabled()) return;
+	Counters counters = { role, index, { -1, -1, -1, -1, -1 } };
+#ifdef __linux__
+	counters.fds[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	int error = errno;
+	counters.fds[1] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	counters.fds[2] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	counters.fds[3] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+	counters.fds[4] = openCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+#endif
+	std::lock_guard<std::mutex> lock(m);
+
+	// warned about once, e.g. in virtual machines without access to the performance monitoring unit
+	if (attached.empty() && counters.fds[0] < 0) {
+#ifdef __linux__
+		std::cerr << "hardware performance counters unavailable (" << std::strerror(error) << "), they will read as zero" << std::endl;
+#else
+		std::cerr << "performance counters are only available on Linux, they will read as zero" << std::endl;
+#endif
+	}
+	attached.push_back(counters);
+}
+
+PerfSample PerfCounters::read(const char* role, int index) {
+	PerfSample total;
+	std::lock_guard<std::mutex> lock(m);
+	for (const Counters& counters : attached) {
+		if (counters.role != role || (index >= 0 && counters.index != index)) continue;
+		unsigned long long values[EVENTS] = {};
+#ifdef __linux__
+		for (int i = 0; i < EVENTS; i++) {
+			if (counters.fds[i] < 0 || ::read(counters.fds[i], &values[i], sizeof(values[i])) != sizeof(values[i])) values[i] = 0;
+		}
+#endif
+		PerfSample sample;
+		sample.cycles = values[0];
+		sample.instructions = values[1];
+		sample.cacheMisses = values[2];
+		sample.branchMisses = values[3];
+		sample.contextSwitches = values[4];
+		total += sample;
+	}
+	return total;
+}
+
+std::string PerfCounters::summary() {
+	std::vector<std::string> roles;
+	m.lock();
+	for (const Counters& counters : attached) {
+		bool seen = false;
+		for (const std::string& role : roles) seen = seen || role == counters.role;
+		if (!seen) roles.push_back(counters.role);
+	}
+	m.unlock();
+
+	std::stringstream ss;
+	ss << "{";
+	for (size_t i = 0; i < roles.size(); i++) ss << (i > 0 ? ", " : "") << "\"" << roles[i] << "\": " << read(roles[i].c_str()).toString();
+	ss << "}";
+	return ss.str();
+}
+
+static void requestSummary(int) {
+	summaryRequested = 1;
+}
+
+void PerfCounters::listen() {
+#ifndef _WIN32
+	std::signal(SIGUSR2, requestSummary);
+#endif
+}
+
+void PerfCounters::poll(std::ostream& out) {
+	if (!summaryRequested) return;
+	summaryRequested = 0;
+	out << summary() << std::endl;
+}
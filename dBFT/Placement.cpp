@@ -0,0 +1,201 @@
+// Placement class reads the processor topology and pins the simulation's threads to it, so that hash rates and round latencies
+// are measured without run to run noise from the scheduler moving threads between cores, SMT siblings and sockets.
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <cstring>
+#include <cstdlib>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+#include "Placement.h"
+
+extern const char* const PLACEMENT;
+
+std::vector<Core> Placement::cores;
+std::vector<std::vector<int>> Placement::nodes;
+std::vector<int> Placement::generator;
+std::vector<int> Placement::monitor;
+
+bool Placement::enabled() {
+	return std::strcmp(PLACEMENT, "none") != 0;
+}
+
+#ifdef _WIN32
+// processors of the calling process's group, grouped into cores and NUMA nodes
+std::vector<Core> Placement::detect() {
+	std::vector<Core> found;
+	DWORD length = 0;
+	GetLogicalProcessorInformation(nullptr, &length);
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+	if (!GetLogicalProcessorInformation(info.data(), &length)) return found;
+
+	for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& relation : info) {
+		if (relation.Relationship != RelationProcessorCore) continue;
+		Core core = { 0, 0, static_cast<int>(found.size()), {} };
+		for (int i = 0; i < 64; i++) if (relation.ProcessorMask & (1ULL << i)) core.processors.push_back(i);
+		found.push_back(core);
+	}
+	for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& relation : info) {
+		if (relation.Relationship != RelationNumaNode) continue;
+		for (Core& core : found) {
+			if (relation.ProcessorMask & (1ULL << core.processors[0])) core.numaNode = static_cast<int>(relation.NumaNode.NodeNumber);
+		}
+	}
+	return found;
+}
+
+void Placement::apply(const std::vector<int>& processors) {
+	DWORD_PTR mask = 0;
+	for (int p : processors) mask |= (static_cast<DWORD_PTR>(1) << p);
+	if (mask != 0) SetThreadAffinityMask(GetCurrentThread(), mask);
+}
+#else
+static int readNumber(const std::string& path, int otherwise) {
+	std::ifstream file(path);
+	int value;
+	return (file >> value ? value : otherwise);
+}
+
+// processors the process may run on (respecting taskset and cgroups), grouped into cores and NUMA nodes from sysfs
+std::vector<Core> Placement::detect() {
+	std::vector<Core> found;
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return found;
+
+	std::map<std::pair<int, int>, size_t> index; // package and core id to position in found
+	for (int p = 0; p < CPU_SETSIZE; p++) {
+		if (!CPU_ISSET(p, &allowed)) continue;
+		std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(p);
+		int package = readNumber(topology + "/topology/physical_package_id", 0);
+		int id = readNumber(topology + "/topology/core_id", p);
+
+		// the processor's directory links to its NUMA node
+		int numaNode = 0;
+		if (DIR* directory = opendir(topology.c_str())) {
+			while (dirent* entry = readdir(directory)) {
+				if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') numaNode = std::atoi(entry->d_name + 4);
+			}
+			closedir(directory);
+		}
+
+		auto key = std::make_pair(package, id);
+		if (index.find(key) == index.end()) {
+			index[key] = found.size();
+			found.push_back({ numaNode, package, id, {} });
+		}
+		found[index[key]].processors.push_back(p);
+	}
+	return found;
+}
+
+void Placement::apply(const std::vector<int>& processors) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int p : processors) CPU_SET(p, &set);
+	if (!processors.empty()) sched_setaffinity(0, sizeof(set), &set);
+}
+#endif
+
+void Placement::configure(const std::vector<unsigned>& weights) {
+	if (!enabled()) return;
+	cores = detect();
+	if (cores.empty()) return;
+
+	std::sort(cores.begin(), cores.end(), [](const Core& a, const Core& b) {
+		return std::make_tuple(a.numaNode, a.package, a.id) < std::make_tuple(b.numaNode, b.package, b.id);
+	});
+
+	// deal the cores out to NUMA nodes in turn
+	if (std::strcmp(PLACEMENT, "spread") == 0) {
+		std::map<int, std::vector<Core>> byNode;
+		for (const Core& core : cores) byNode[core.numaNode].push_back(core);
+		std::vector<Core> dealt;
+		for (size_t round = 0; dealt.size() < cores.size(); round++) {
+			for (auto& node : byNode) if (round < node.second.size()) dealt.push_back(node.second[round]);
+		}
+		cores = dealt;
+	}
+
+	// the generator and display take the last cores when that leaves a core for every node thread
+	unsigned wanted = 0;
+	for (unsigned w : weights) wanted += std::max(1u, w);
+	size_t reserved = (cores.size() >= wanted + 2 ? 2 : cores.size() >= wanted + 1 ? 1 : 0);
+	std::vector<Core> service(cores.end() - reserved, cores.end());
+	std::vector<Core> mining(cores.begin(), cores.end() - reserved);
+	if (mining.empty()) mining = cores;
+
+	// the first processor of every core is used before any sibling
+	std::vector<int> slots;
+	for (size_t sibling = 0; ; sibling++) {
+		size_t added = 0;
+		for (const Core& core : mining) {
+			if (sibling < core.processors.size()) {
+				slots.push_back(core.processors[sibling]);
+				added++;
+			}
+		}
+		if (added == 0) break;
+	}
+
+	nodes.clear();
+	size_t next = 0;
+	for (unsigned w : weights) {
+		std::vector<int> processors;
+		for (unsigned i = 0; i < std::max(1u, w); i++) processors.push_back(slots[next++ % slots.size()]);
+		std::sort(processors.begin(), processors.end());
+		processors.erase(std::unique(processors.begin(), processors.end()), processors.end());
+		nodes.push_back(processors);
+	}
+
+	// without cores of their own the generator and display share the last core
+	const Core& last = cores.back();
+	generator = (reserved >= 1 ? service.back().processors : last.processors);
+	monitor = (reserved >= 2 ? service.front().processors : generator);
+}
+
+void Placement::pin(const char* role, int index) {
+	if (!enabled() || cores.empty()) return;
+	if (std::strcmp(role, "node") == 0 && index >= 0 && index < static_cast<int>(nodes.size())) apply(nodes[index]);
+	else if (std::strcmp(role, "generator") == 0) apply(generator);
+	else if (std::strcmp(role, "monitor") == 0) apply(monitor);
+}
+
+std::string Placement::describe() {
+	std::stringstream ss;
+	ss << "placement: " << PLACEMENT;
+	if (!enabled()) return ss.str();
+	if (cores.empty()) {
+		ss << " (processor topology unavailable, threads are not pinned)";
+		return ss.str();
+	}
+
+	std::vector<int> numaNodes;
+	size_t processors = 0;
+	for (const Core& core : cores) {
+		if (std::find(numaNodes.begin(), numaNodes.end(), core.numaNode) == numaNodes.end()) numaNodes.push_back(core.numaNode);
+		processors += core.processors.size();
+	}
+	ss << ", " << cores.size() << " core" << (cores.size() > 1 ? "s" : "") << " (" << processors << " processor" << (processors > 1 ? "s" : "") << ") on " << numaNodes.size() << " NUMA node" << (numaNodes.size() > 1 ? "s" : "");
+
+	auto list = [&ss](const std::vector<int>& processors) {
+		for (size_t i = 0; i < processors.size(); i++) ss << (i > 0 ? "," : "") << processors[i];
+	};
+	for (size_t i = 0; i < nodes.size(); i++) {
+		ss << "\n  node " << i << ": ";
+		list(nodes[i]);
+	}
+	ss << "\n  generator: ";
+	list(generator);
+	ss << "\n  display: ";
+	list(monitor);
+	return ss.str();
+}
@@ -0,0 +1,59 @@
+// Proposal class carries the speaker's block proposal to the delegates.
+// The block (Merkle tree and hash) is built lazily and memoized, so it is computed once per round rather than once per node,
+// and the block added to every chain is the one that was verified.
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "Proposal.h"
+#include "Block.h"
+#include "Transaction.h"
+#include "MerkleTree.h"
+#include "Serialization.h"
+
+Proposal::Proposal(std::string previousHash, std::vector<Transaction> transactions, bool honest) :previousHash(previousHash), transactions(transactions) {
+	hash = (honest ? getBlock().hash : "");
+}
+
+Proposal::Proposal(std::string previousHash, std::vector<Transaction> transactions, const MerkleTree& tree, bool honest) :previousHash(previousHash), transactions(transactions) {
+	std::call_once(built, [this, &tree] { block = std::make_shared<const Block>(this->previousHash, tree); });
+	hash = (honest ? getBlock().hash : "");
+}
+
+const Block& Proposal::getBlock() const {
+	std::call_once(built, [this] { block = std::make_shared<const Block>(previousHash, transactions); });
+	return *block;
+}
+
+bool Proposal::isValid(const std::string& previousHash) const {
+	return previousHash == this->previousHash && getBlock().hash == hash;
+}
+
+void Proposal::serialize(std::vector<unsigned char>& bytes, bool compact) const {
+	bytes.reserve(bytes.size() + wireSize(compact));
+	bytes.push_back(WIRE_VERSION);
+	putHash(bytes, previousHash);
+	putHash(bytes, hash);
+	putInteger(bytes, transactions.size(), 4);
+	bytes.push_back(compact ? 1 : 0);
+
+	if (compact) {
+		for (const Transaction& t : transactions) putInteger(bytes, t.id, 4);
+		return;
+	}
+	size_t position = bytes.size();
+	bytes.resize(position + TransactionView::SIZE * transactions.size());
+	for (const Transaction& t : transactions) {
+		t.serialize(&bytes[position]);
+		position += TransactionView::SIZE;
+	}
+}
+
+size_t Proposal::wireSize(bool compact) const {
+	return ProposalView::HEADER_SIZE + (compact ? 4 : TransactionView::SIZE) * transactions.size();
+}
+
+size_t Proposal::transferSize(bool compact) const {
+	return wireSize(compact) + (compact ? 0 : payloadSize(transactions));
+}
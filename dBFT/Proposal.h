@@ -0,0 +1,45 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "Block.h"
+#include "Transaction.h"
+#include "MerkleTree.h"
+
+#ifndef PROPOSAL_H
+#define PROPOSAL_H
+
+// a block proposal published by the speaker, shared read-only by all nodes
+class Proposal {
+
+private:
+
+	// the block is built at most once, by whichever node first needs it
+	mutable std::once_flag built;
+	mutable std::shared_ptr<const Block> block;
+
+public:
+
+	std::string previousHash;
+	std::vector<Transaction> transactions;
+	std::string hash; // the hash of the block as claimed by the speaker
+
+	// an honest speaker claims the true hash of the block, a malicious one does not
+	Proposal(std::string previousHash, std::vector<Transaction> transactions, bool honest);
+	// for a speaker that has already built the Merkle tree of the transactions
+	Proposal(std::string previousHash, std::vector<Transaction> transactions, const MerkleTree& tree, bool honest);
+
+	const Block& getBlock() const;
+	// checks the claimed hash against the block built on the validating node's own chain
+	bool isValid(const std::string& previousHash) const;
+
+	// appends the binary encoding of the proposal (see Serialization.h), compact proposals only identify the transactions
+	void serialize(std::vector<unsigned char>& bytes, bool compact) const;
+	// bytes of the encoded proposal
+	size_t wireSize(bool compact) const;
+	// bytes sent for the proposal, which include the contents of its transactions unless they are only identified
+	size_t transferSize(bool compact) const;
+};
+
+#endif
@@ -0,0 +1,12 @@
+// names of the messages nodes pass between them, for the timeline
+#include "Semaphore.h"
+
+const char* describe(Semaphore semaphore) {
+	switch (semaphore) {
+	case Semaphore::PrepareRequest: return "PrepareRequest";
+	case Semaphore::PrepareResponse: return "PrepareResponse";
+	case Semaphore::ChangeView: return "ChangeView";
+	case Semaphore::BlockPublished: return "BlockPublished";
+	default: return "Unknown";
+	}
+}
@@ -18,4 +18,7 @@ enum class Semaphore {
 	BlockPublished
 };
 
+// the name of a type of message
+const char* describe(Semaphore semaphore);
+
 #endif
@@ -0,0 +1,115 @@
+// Serialization of proposals and transactions into the binary form they would take on a real network.
+// Encodings are read through views that decode single fields on demand, and the size of every transfer between nodes is known.
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Serialization.h"
+#include "Transaction.h"
+
+static const char digits[] = "0123456789abcdef";
+
+static int digitValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return 0;
+}
+
+void putInteger(std::vector<unsigned char>& bytes, uint64_t value, int count) {
+	for (int i = 0; i < count; i++) {
+		bytes.push_back(static_cast<unsigned char>(value & 0xFF));
+		value >>= 8;
+	}
+}
+
+uint64_t getInteger(const unsigned char* bytes, int count) {
+	uint64_t value = 0;
+	for (int i = count - 1; i >= 0; i--) value = (value << 8) | bytes[i];
+	return value;
+}
+
+void putHash(std::vector<unsigned char>& bytes, const std::string& hash) {
+	for (size_t i = 0; i < 32; i++) {
+		int high = (2 * i < hash.size() ? digitValue(hash[2 * i]) : 0);
+		int low = (2 * i + 1 < hash.size() ? digitValue(hash[2 * i + 1]) : 0);
+		bytes.push_back(static_cast<unsigned char>(high << 4 | low));
+	}
+}
+
+std::string getHash(const unsigned char* bytes) {
+	bool empty = true;
+	for (size_t i = 0; i < 32; i++) empty = empty && bytes[i] == 0;
+	if (empty) return "";
+
+	std::string hash(64, '0');
+	for (size_t i = 0; i < 32; i++) {
+		hash[2 * i] = digits[bytes[i] >> 4];
+		hash[2 * i + 1] = digits[bytes[i] & 0xF];
+	}
+	return hash;
+}
+
+size_t payloadSize(const std::vector<Transaction>& transactions) {
+	size_t total = 0;
+	for (const Transaction& t : transactions) total += t.size;
+	return total;
+}
+
+TransactionView::TransactionView(const unsigned char* data) :data(data) {}
+
+unsigned int TransactionView::id() const {
+	return static_cast<unsigned int>(getInteger(data, 4));
+}
+
+unsigned int TransactionView::input() const {
+	return static_cast<unsigned int>(getInteger(data + 4, 4));
+}
+
+unsigned int TransactionView::output() const {
+	return static_cast<unsigned int>(getInteger(data + 8, 4));
+}
+
+unsigned int TransactionView::size() const {
+	return static_cast<unsigned int>(getInteger(data + 12, 4));
+}
+
+Transaction TransactionView::toTransaction() const {
+	return Transaction(id(), input(), output(), size());
+}
+
+ProposalView::ProposalView(const unsigned char* data, size_t length) :data(data), length(length) {
+	if (length < HEADER_SIZE || data[0] != WIRE_VERSION) return;
+	valid = (length >= HEADER_SIZE + (data[69] != 0 ? 4 : TransactionView::SIZE) * getInteger(data + 65, 4));
+}
+
+ProposalView::ProposalView(const std::vector<unsigned char>& bytes) :ProposalView(bytes.data(), bytes.size()) {}
+
+bool ProposalView::isValid() const {
+	return valid;
+}
+
+std::string ProposalView::previousHash() const {
+	return getHash(data + 1);
+}
+
+std::string ProposalView::hash() const {
+	return getHash(data + 33);
+}
+
+bool ProposalView::isCompact() const {
+	return data[69] != 0;
+}
+
+unsigned ProposalView::transactionCount() const {
+	return static_cast<unsigned>(getInteger(data + 65, 4));
+}
+
+unsigned ProposalView::transactionId(unsigned index) const {
+	if (isCompact()) return static_cast<unsigned>(getInteger(data + HEADER_SIZE + 4 * index, 4));
+	return transaction(index).id();
+}
+
+TransactionView ProposalView::transaction(unsigned index) const {
+	return TransactionView(data + HEADER_SIZE + TransactionView::SIZE * index);
+}
@@ -0,0 +1,80 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "Transaction.h"
+
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+// proposals are encoded in a compact little-endian binary form, as they would be sent between nodes
+// encoded proposal: version (1 byte), previous hash (32), claimed hash (32, all zeros if none is claimed),
+//                   then the number of transactions (4), whether the proposal is compact (1)
+//                   and the transactions (16 each), or for compact proposals only their ids (4 each)
+// encoded transaction: id, input, output and size (4 bytes each)
+
+// written at the start of every encoded proposal so that encodings from other versions are rejected
+const unsigned char WIRE_VERSION = 2;
+
+// bytes of a message between nodes: its type and three integers
+const size_t MESSAGE_SIZE = 13;
+
+void putInteger(std::vector<unsigned char>& bytes, uint64_t value, int count);
+uint64_t getInteger(const unsigned char* bytes, int count);
+// hashes are hexadecimal SHA-256 digests, stored as the 32 bytes they represent (an empty hash is stored as zeros)
+void putHash(std::vector<unsigned char>& bytes, const std::string& hash);
+std::string getHash(const unsigned char* bytes);
+// bytes of the transactions' contents, which the encoding only records the size of (zero unless they were replayed from a trace)
+size_t payloadSize(const std::vector<Transaction>& transactions);
+
+// reads the fields of an encoded transaction in place
+class TransactionView {
+
+private:
+
+	const unsigned char* data;
+
+public:
+
+	static const size_t SIZE = 16;
+
+	TransactionView(const unsigned char* data);
+
+	unsigned int id() const;
+	unsigned int input() const;
+	unsigned int output() const;
+	unsigned int size() const;
+	Transaction toTransaction() const;
+};
+
+// reads the fields of an encoded proposal in place, without decoding its transactions
+class ProposalView {
+
+private:
+
+	const unsigned char* data;
+	size_t length;
+	bool valid = false;
+
+public:
+
+	static const size_t HEADER_SIZE = 70;
+
+	ProposalView(const unsigned char* data, size_t length);
+	ProposalView(const std::vector<unsigned char>& bytes);
+
+	// false if the encoding is truncated or of another version
+	bool isValid() const;
+
+	std::string previousHash() const;
+	std::string hash() const;
+	// true if the transactions are only identified, to be found in the receiver's memory
+	bool isCompact() const;
+	unsigned transactionCount() const;
+	unsigned transactionId(unsigned index) const;
+	// only for full proposals
+	TransactionView transaction(unsigned index) const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+// SpeakerSchedule class replaces a centralised speaker selection: nodes agreeing on the blockchain agree on every speaker.
+// The previous block hash is folded with FNV-1a and mixed with the height and view, far cheaper than hashing it again with SHA-256.
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+#include "SpeakerSchedule.h"
+
+SpeakerSchedule::SpeakerSchedule(unsigned nodes, const char* stakes) {
+	std::stringstream list(stakes);
+	std::string entry;
+	unsigned long long stake = 1, total = 0;
+	for (unsigned i = 0; i < nodes; i++) {
+		if (std::getline(list, entry, ',') && !entry.empty()) stake = std::stoull(entry);
+		total += stake;
+		cumulative.push_back(total);
+	}
+
+	// a schedule without any stake falls back to equal stakes
+	if (total == 0) {
+		for (unsigned i = 0; i < nodes; i++) cumulative[i] = i + 1;
+	}
+}
+
+// splitmix64 finaliser, every input bit affects every output bit
+unsigned long long SpeakerSchedule::mix(unsigned long long x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+unsigned SpeakerSchedule::speaker(const std::string& previousHash, int height, int view) const {
+	unsigned long long h = 0xcbf29ce484222325ULL;
+	for (char c : previousHash) {
+		h ^= static_cast<unsigned char>(c);
+		h *= 0x100000001b3ULL;
+	}
+	h = mix(h ^ mix((static_cast<unsigned long long>(static_cast<unsigned>(height)) << 32) | static_cast<unsigned>(view)));
+
+	// the bias of the remainder is negligible for any realistic total stake
+	unsigned long long ticket = h % cumulative.back();
+	return static_cast<unsigned>(std::upper_bound(cumulative.begin(), cumulative.end(), ticket) - cumulative.begin());
+}
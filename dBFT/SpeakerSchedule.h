@@ -0,0 +1,26 @@
+#include <vector>
+#include <string>
+
+#ifndef SPEAKERSCHEDULE_H
+#define SPEAKERSCHEDULE_H
+
+// decides which node is the speaker at each height and view from the hash of the previous block
+// fixed once constructed, so every node evaluates it independently and without locks
+// each node is chosen in proportion to its stake, equal stakes giving every node the same chance
+class SpeakerSchedule {
+
+private:
+
+	std::vector<unsigned long long> cumulative; // running total of the stakes by node id
+	
+	static unsigned long long mix(unsigned long long x);
+
+public:
+
+	// the stakes are a comma-separated list by node id whose last entry applies to the remaining nodes, empty for equal stakes
+	SpeakerSchedule(unsigned nodes, const char* stakes);
+
+	unsigned speaker(const std::string& previousHash, int height, int view) const;
+};
+
+#endif
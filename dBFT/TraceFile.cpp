@@ -0,0 +1,110 @@
+// TraceFile class gives access to a recorded workload for replay.
+// The file is memory-mapped and the operating system told it will be read in order, so pages are read ahead of the replay
+// and records are decoded in place without copying the file or parsing text.
+#include <string>
+#include <cstring>
+#include <cstdint>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "TraceFile.h"
+
+static const char magic[8] = { 'T', 'X', 'T', 'R', 'A', 'C', 'E', '\0' };
+
+// fields are little-endian whatever the byte order of the machine replaying them
+static uint64_t readLittleEndian(const unsigned char* bytes, int count) {
+	uint64_t value = 0;
+	for (int i = count - 1; i >= 0; i--) value = (value << 8) | bytes[i];
+	return value;
+}
+
+TraceFile::TraceFile(const std::string& path) {
+#ifdef _WIN32
+	HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (f == INVALID_HANDLE_VALUE) return;
+	file = f;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(f, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(HEADER_SIZE)) {
+		unmap();
+		return;
+	}
+	length = static_cast<size_t>(fileSize.QuadPart);
+	mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		unmap();
+		return;
+	}
+	data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	file = open(path.c_str(), O_RDONLY);
+	if (file < 0) return;
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(HEADER_SIZE)) {
+		unmap();
+		return;
+	}
+	length = static_cast<size_t>(status.st_size);
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+	if (mapped != MAP_FAILED) {
+		data = static_cast<const unsigned char*>(mapped);
+		madvise(mapped, length, MADV_SEQUENTIAL);
+		madvise(mapped, length, MADV_WILLNEED);
+	}
+#endif
+	if (data == nullptr) {
+		unmap();
+		return;
+	}
+
+	// a file of another format or version is treated as an empty trace
+	if (std::memcmp(data, magic, sizeof(magic)) != 0 || readLittleEndian(data + 8, 4) != VERSION) {
+		unmap();
+		return;
+	}
+	records = (length - HEADER_SIZE) / RECORD_SIZE;
+}
+
+TraceFile::~TraceFile() {
+	unmap();
+}
+
+void TraceFile::unmap() {
+#ifdef _WIN32
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mapping != nullptr) CloseHandle(mapping);
+	if (file != nullptr) CloseHandle(file);
+	mapping = nullptr;
+	file = nullptr;
+#else
+	if (data != nullptr) munmap(const_cast<unsigned char*>(data), length);
+	if (file >= 0) close(file);
+	file = -1;
+#endif
+	data = nullptr;
+	length = 0;
+	records = 0;
+}
+
+bool TraceFile::isOpen() const {
+	return data != nullptr;
+}
+
+size_t TraceFile::size() const {
+	return records;
+}
+
+TraceRecord TraceFile::operator[](size_t index) const {
+	const unsigned char* record = data + HEADER_SIZE + index * RECORD_SIZE;
+	TraceRecord r;
+	r.time = readLittleEndian(record, 8);
+	r.id = static_cast<uint32_t>(readLittleEndian(record + 8, 4));
+	r.size = static_cast<uint32_t>(readLittleEndian(record + 12, 4));
+	return r;
+}
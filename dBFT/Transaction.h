@@ -8,14 +8,12 @@
 
 class Transaction {
 
-private:
-	std::string toHexString(unsigned int i);
-
 public:
 
 	unsigned int id;
 	unsigned int input;
 	unsigned int output;
+	unsigned int size; // bytes, only known for transactions replayed from a trace
 	time_t creationTime;
 	time_t confirmationTime;
 
@@ -23,9 +21,11 @@ public:
 	static std::mutex f; // protects .csv output
 
 	Transaction();
-	Transaction(unsigned int id, unsigned int input, unsigned int output);
+	Transaction(unsigned int id, unsigned int input, unsigned int output, unsigned int size = 0);
 
-	std::string toString();
+	// writes the 16 byte binary encoding of the transaction (see Serialization.h)
+	void serialize(unsigned char* bytes) const;
+	std::string toString() const;
 	void confirm();
 
 };
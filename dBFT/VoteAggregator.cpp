@@ -0,0 +1,166 @@
+// VoteAggregator class counts the responses to each proposal in one place shared by all nodes.
+// Votes are stored as bitsets so that duplicates are ignored and totals are a popcount, and nodes waiting
+// for a decision are woken when a supermajority is crossed rather than scanning their message queues.
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <climits>
+#include <algorithm>
+#include <condition_variable>
+
+#include "VoteAggregator.h"
+#include "Semaphore.h"
+#include "Proposal.h"
+
+static const double supermajority = 2.0 / 3.0;
+static const unsigned bitsPerWord = 64;
+
+VoteAggregator::Tally::Tally(unsigned nodes, const std::atomic<bool>& stopped) :nodes(nodes), stopped(stopped), approvals((nodes + bitsPerWord - 1) / bitsPerWord), rejections((nodes + bitsPerWord - 1) / bitsPerWord) {
+	for (auto& word : approvals) word.store(0);
+	for (auto& word : rejections) word.store(0);
+	published.store(false);
+}
+
+bool VoteAggregator::Tally::set(std::vector<std::atomic<unsigned long long>>& bits, unsigned node) {
+	unsigned long long bit = 1ULL << (node % bitsPerWord);
+	return (bits[node / bitsPerWord].fetch_or(bit) & bit) == 0;
+}
+
+unsigned VoteAggregator::Tally::count(const std::vector<std::atomic<unsigned long long>>& bits) {
+	unsigned total = 0;
+	for (auto& word : bits) total += static_cast<unsigned>(std::bitset<bitsPerWord>(word.load()).count());
+	return total;
+}
+
+bool VoteAggregator::Tally::record(Semaphore flag, unsigned node) {
+	bool recorded = false;
+	switch (flag) {
+
+	// the speaker backs their own proposal
+	case Semaphore::PrepareRequest:
+	// response of a delegate that approves of the proposal
+	case Semaphore::PrepareResponse:
+		recorded = set(approvals, node);
+		break;
+
+	// approving nodes can however later request a view change
+	// progression still only occurs if a 2/3 majority is reached, preserving safety properties
+	case Semaphore::ChangeView:
+		recorded = set(rejections, node);
+		break;
+
+	// if a block has been published consensus has been reached
+	case Semaphore::BlockPublished:
+		recorded = !published.exchange(true);
+		break;
+	}
+
+	// wake waiting nodes if this vote decides the round or abandons the view
+	// the lock is taken so a waiter cannot miss the notification between checking and sleeping
+	if (recorded && (isPublished() || decided() || abandoned())) {
+		std::lock_guard<std::mutex> lock(m);
+		crossed.notify_all();
+	}
+	return recorded;
+}
+
+unsigned VoteAggregator::Tally::getApprovals() const {
+	return count(approvals);
+}
+
+unsigned VoteAggregator::Tally::getRejections() const {
+	return count(rejections);
+}
+
+bool VoteAggregator::Tally::isPublished() const {
+	return published.load();
+}
+
+bool VoteAggregator::Tally::approved() const {
+	return getApprovals() > supermajority * nodes;
+}
+
+bool VoteAggregator::Tally::rejected() const {
+	return getRejections() > supermajority * nodes;
+}
+
+bool VoteAggregator::Tally::abandoned() const {
+	return getRejections() > (nodes - 1) / 3;
+}
+
+bool VoteAggregator::Tally::decided() const {
+	return approved() || rejected() || getApprovals() + getRejections() >= nodes;
+}
+
+void VoteAggregator::Tally::setProposal(std::shared_ptr<const Proposal> proposal) {
+	std::lock_guard<std::mutex> lock(m);
+	this->proposal = proposal;
+}
+
+std::shared_ptr<const Proposal> VoteAggregator::Tally::getProposal() {
+	std::lock_guard<std::mutex> lock(m);
+	return proposal;
+}
+
+void VoteAggregator::Tally::await(std::chrono::system_clock::time_point deadline, bool untilAbandoned) {
+	std::unique_lock<std::mutex> lock(m);
+	crossed.wait_until(lock, deadline, [this, untilAbandoned] { return isPublished() || decided() || (untilAbandoned && abandoned()) || stopped; });
+}
+
+void VoteAggregator::Tally::wake() {
+	std::lock_guard<std::mutex> lock(m);
+	crossed.notify_all();
+}
+
+VoteAggregator::VoteAggregator(unsigned nodes) :nodes(nodes), heights(nodes, INT_MAX) {
+	for (auto& slot : abandoned) slot.store(-1);
+}
+
+std::shared_ptr<VoteAggregator::Tally> VoteAggregator::getTally(int height, int view) {
+	std::lock_guard<InstrumentedMutex> lock(m);
+	std::shared_ptr<Tally>& tally = tallies[std::make_pair(height, view)];
+	if (tally == nullptr) tally = std::make_shared<Tally>(nodes, stopped);
+	return tally;
+}
+
+bool VoteAggregator::record(int height, int view, Semaphore flag, unsigned node) {
+	std::shared_ptr<Tally> tally = getTally(height, view);
+	if (!tally->record(flag, node)) return false;
+
+	// remembered outside the tallies so that nodes can check for it without taking the lock
+	if (flag == Semaphore::ChangeView && tally->abandoned()) {
+		long long key = (static_cast<long long>(height) << 32) | static_cast<unsigned>(view);
+		std::atomic<long long>& slot = abandoned[height % ABANDONED_HEIGHTS];
+		long long latest = slot.load();
+		while (key > latest && !slot.compare_exchange_weak(latest, key));
+	}
+	return true;
+}
+
+int VoteAggregator::abandonedView(int height) const {
+	long long latest = abandoned[height % ABANDONED_HEIGHTS].load();
+	return ((latest >> 32) == height ? static_cast<int>(latest & 0xffffffff) : -1);
+}
+
+// nodes that never advance (i.e. unresponsive ones) do not hold back the discarding of old tallies
+void VoteAggregator::advance(unsigned node, int height) {
+	std::lock_guard<InstrumentedMutex> lock(m);
+	heights[node] = height;
+	int lowest = *std::min_element(heights.begin(), heights.end());
+
+	// nodes still waiting on a discarded tally keep it alive through their own reference
+	auto end = tallies.lower_bound(std::make_pair(lowest, INT_MIN));
+	tallies.erase(tallies.begin(), end);
+}
+
+// a node waits at its own height, which is never below that of the slowest node, so every tally being waited on is still held here
+void VoteAggregator::stop() {
+	std::lock_guard<InstrumentedMutex> lock(m);
+	stopped = true;
+	for (auto& tally : tallies) tally.second->wake();
+}
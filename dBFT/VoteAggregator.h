@@ -0,0 +1,99 @@
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+#include "Semaphore.h"
+#include "Proposal.h"
+#include "InstrumentedMutex.h"
+
+#ifndef VOTEAGGREGATOR_H
+#define VOTEAGGREGATOR_H
+
+// collects the proposal and the responses of all nodes for each view
+// a vote is recorded once by its sender rather than being recounted by every receiver
+class VoteAggregator {
+
+public:
+
+	// the votes cast at a single block height and view
+	class Tally {
+
+	private:
+
+		const unsigned nodes;
+		const std::atomic<bool>& stopped; // set by the aggregator when the simulation stops
+
+		// one bit per node, set when that node's vote is recorded
+		std::vector<std::atomic<unsigned long long>> approvals;
+		std::vector<std::atomic<unsigned long long>> rejections;
+		std::atomic<bool> published;
+
+		// waiters sleep here until a quorum is crossed, also protects the proposal
+		std::mutex m;
+		std::shared_ptr<const Proposal> proposal;
+		std::condition_variable crossed;
+
+		// returns true if the node's bit was not already set
+		static bool set(std::vector<std::atomic<unsigned long long>>& bits, unsigned node);
+		static unsigned count(const std::vector<std::atomic<unsigned long long>>& bits);
+
+	public:
+
+		Tally(unsigned nodes, const std::atomic<bool>& stopped);
+
+		// returns false if the node has already cast this kind of vote
+		bool record(Semaphore flag, unsigned node);
+
+		unsigned getApprovals() const;
+		unsigned getRejections() const;
+		bool isPublished() const;
+		// more than 2/3 of nodes back the proposal
+		bool approved() const;
+		// more than 2/3 of nodes have requested a view change
+		bool rejected() const;
+		// more than f = (n - 1) / 3 nodes have requested a view change, so at least one honest node has given up on the view
+		bool abandoned() const;
+		// nothing more can be learnt from waiting for votes
+		bool decided() const;
+
+		void setProposal(std::shared_ptr<const Proposal> proposal);
+		std::shared_ptr<const Proposal> getProposal();
+
+		// blocks until the tally is decided, the block is published, the simulation stops or the deadline passes
+		// and optionally until the view is abandoned
+		void await(std::chrono::system_clock::time_point deadline, bool untilAbandoned);
+		// wakes the nodes waiting on the tally to check it again
+		void wake();
+	};
+
+	VoteAggregator(unsigned nodes);
+
+	std::shared_ptr<Tally> getTally(int height, int view);
+	// returns false if the vote has already been counted
+	bool record(int height, int view, Semaphore flag, unsigned node);
+	// the latest view at the given height abandoned by more than f nodes, or -1 if there is none
+	int abandonedView(int height) const;
+	// called as a node reaches a new block height, tallies below the height of the slowest node are discarded
+	void advance(unsigned node, int height);
+	// wakes every node waiting for votes, which then stop waiting, so that the simulation can finish
+	void stop();
+
+private:
+
+	const unsigned nodes;
+	InstrumentedMutex m{ "VoteAggregator::m" }; // protects tallies and heights
+	std::map<std::pair<int, int>, std::shared_ptr<Tally>> tallies;
+	std::vector<int> heights;
+	std::atomic<bool> stopped{ false };
+	// the latest abandoned view of recent heights, each packed as (height << 32) | view so that later ones compare greater
+	// nodes are at most a height or two apart, so heights share a slot only once nothing can still be waiting at the older one
+	static const int ABANDONED_HEIGHTS = 16;
+	std::array<std::atomic<long long>, ABANDONED_HEIGHTS> abandoned;
+};
+
+#endif